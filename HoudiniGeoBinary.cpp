@@ -0,0 +1,448 @@
+#include "HoudiniGeoBinary.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace HoudiniGeoBinary {
+
+namespace {
+
+// UT_JID 定义
+enum : uint8_t {
+    JID_NULL = 0x00,
+    JID_MAP_BEGIN = 0x7b,
+    JID_MAP_END = 0x7d,
+    JID_ARRAY_BEGIN = 0x5b,
+    JID_ARRAY_END = 0x5d,
+    JID_BOOL = 0x10,
+    JID_INT8 = 0x11,
+    JID_INT16 = 0x12,
+    JID_INT32 = 0x13,
+    JID_INT64 = 0x14,
+    JID_REAL16 = 0x18,
+    JID_REAL32 = 0x19,
+    JID_REAL64 = 0x1a,
+    JID_UINT8 = 0x21,
+    JID_UINT16 = 0x22,
+    JID_STRING = 0x27,
+    JID_FALSE = 0x30,
+    JID_TRUE = 0x31,
+    JID_TOKENDEF = 0x2b,
+    JID_TOKENREF = 0x26,
+    JID_TOKENUNDEF = 0x2d,
+    JID_UNIFORM_ARRAY = 0x40,
+    JID_KEY_SEPARATOR = 0x3a,
+    JID_VALUE_SEPARATOR = 0x2c,
+    JID_MAGIC = 0x7f,
+};
+
+const uint32_t BINARY_MAGIC = ('b' << 24) | ('J' << 16) | ('S' << 8) | ('N');
+
+template <class T>
+void appendPod(std::string& out, T v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+// 长度编码：小于0xf1直接一个字节，否则0xf2/0xf4/0xf8后跟16/32/64位长度
+void appendLength(std::string& out, uint64_t len) {
+    if (len < 0xf1) {
+        out.push_back(static_cast<char>(len));
+    }
+    else if (len <= 0xffff) {
+        out.push_back(static_cast<char>(0xf2));
+        appendPod<uint16_t>(out, static_cast<uint16_t>(len));
+    }
+    else if (len <= 0xffffffffull) {
+        out.push_back(static_cast<char>(0xf4));
+        appendPod<uint32_t>(out, static_cast<uint32_t>(len));
+    }
+    else {
+        out.push_back(static_cast<char>(0xf8));
+        appendPod<uint64_t>(out, len);
+    }
+}
+
+void appendString(std::string& out, const std::string& s) {
+    out.push_back(static_cast<char>(JID_STRING));
+    appendLength(out, s.size());
+    out.append(s);
+}
+
+uint8_t intTypeFor(int64_t lo, int64_t hi) {
+    if (lo >= std::numeric_limits<int8_t>::min() && hi <= std::numeric_limits<int8_t>::max()) return JID_INT8;
+    if (lo >= std::numeric_limits<int16_t>::min() && hi <= std::numeric_limits<int16_t>::max()) return JID_INT16;
+    if (lo >= std::numeric_limits<int32_t>::min() && hi <= std::numeric_limits<int32_t>::max()) return JID_INT32;
+    return JID_INT64;
+}
+
+bool isExactFloat(double v) {
+    return static_cast<double>(static_cast<float>(v)) == v || std::isnan(v);
+}
+
+int64_t asInt64(const nlohmann::json& v) {
+    if (v.is_number_unsigned()) {
+        return static_cast<int64_t>(v.get<uint64_t>());
+    }
+    return v.get<int64_t>();
+}
+
+void appendInt(std::string& out, uint8_t type, int64_t v) {
+    switch (type) {
+        case JID_INT8: appendPod<int8_t>(out, static_cast<int8_t>(v)); break;
+        case JID_INT16: appendPod<int16_t>(out, static_cast<int16_t>(v)); break;
+        case JID_INT32: appendPod<int32_t>(out, static_cast<int32_t>(v)); break;
+        default: appendPod<int64_t>(out, v); break;
+    }
+}
+
+// 纯数字数组写成 JID_UNIFORM_ARRAY，返回false表示不适用
+bool appendUniformArray(std::string& out, const nlohmann::json& arr) {
+    if (arr.empty()) {
+        return false;
+    }
+    bool allInt = true;
+    bool allExactFloat = true;
+    int64_t lo = std::numeric_limits<int64_t>::max();
+    int64_t hi = std::numeric_limits<int64_t>::min();
+    for (const auto& v : arr) {
+        if (v.is_number_integer()) {
+            if (v.is_number_unsigned() && v.get<uint64_t>() > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                return false;
+            }
+            int64_t i = asInt64(v);
+            lo = std::min(lo, i);
+            hi = std::max(hi, i);
+            allExactFloat = allExactFloat && isExactFloat(static_cast<double>(i));
+        }
+        else if (v.is_number_float()) {
+            allInt = false;
+            allExactFloat = allExactFloat && isExactFloat(v.get<double>());
+        }
+        else {
+            return false;
+        }
+    }
+
+    out.push_back(static_cast<char>(JID_UNIFORM_ARRAY));
+    if (allInt) {
+        uint8_t type = intTypeFor(lo, hi);
+        out.push_back(static_cast<char>(type));
+        appendLength(out, arr.size());
+        for (const auto& v : arr) {
+            appendInt(out, type, asInt64(v));
+        }
+    }
+    else if (allExactFloat) {
+        out.push_back(static_cast<char>(JID_REAL32));
+        appendLength(out, arr.size());
+        for (const auto& v : arr) {
+            appendPod<float>(out, static_cast<float>(v.get<double>()));
+        }
+    }
+    else {
+        out.push_back(static_cast<char>(JID_REAL64));
+        appendLength(out, arr.size());
+        for (const auto& v : arr) {
+            appendPod<double>(out, v.get<double>());
+        }
+    }
+    return true;
+}
+
+float halfToFloat(uint16_t h) {
+    uint32_t sign = (h >> 15) & 1;
+    int exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    float f;
+    if (exp == 0) {
+        f = std::ldexp(static_cast<float>(mant), -24);
+    }
+    else if (exp == 31) {
+        f = mant ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+    }
+    else {
+        f = std::ldexp(static_cast<float>(mant | 0x400), exp - 25);
+    }
+    return sign ? -f : f;
+}
+
+
+class Decoder {
+public:
+    Decoder(const char* data, size_t size)
+        : p(reinterpret_cast<const uint8_t*>(data)), end(p + size) {}
+
+    nlohmann::json parseDocument() {
+        if (p < end && *p == JID_MAGIC) {
+            p++;
+            uint32_t magic = readPod<uint32_t>();
+            if (magic != BINARY_MAGIC) {
+                throw std::runtime_error("Unsupported binary JSON byte order");
+            }
+        }
+        return parseValue(nextId());
+    }
+
+private:
+    template <class T>
+    T readPod() {
+        if (static_cast<size_t>(end - p) < sizeof(T)) {
+            throw std::runtime_error("Unexpected end of binary JSON data");
+        }
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    uint64_t readLength() {
+        uint8_t n = readPod<uint8_t>();
+        if (n < 0xf1) return n;
+        if (n == 0xf2) return readPod<uint16_t>();
+        if (n == 0xf4) return readPod<uint32_t>();
+        if (n == 0xf8) return readPod<uint64_t>();
+        throw std::runtime_error("Invalid length encoding in binary JSON");
+    }
+
+    std::string readRawString() {
+        uint64_t len = readLength();
+        if (static_cast<uint64_t>(end - p) < len) {
+            throw std::runtime_error("Unexpected end of binary JSON string");
+        }
+        std::string s(reinterpret_cast<const char*>(p), static_cast<size_t>(len));
+        p += len;
+        return s;
+    }
+
+    // 跳过分隔符和token取消定义，返回下一个值的类型
+    uint8_t nextId() {
+        for (;;) {
+            uint8_t id = readPod<uint8_t>();
+            if (id == JID_KEY_SEPARATOR || id == JID_VALUE_SEPARATOR) continue;
+            if (id == JID_TOKENUNDEF) {
+                tokens.erase(readLength());
+                continue;
+            }
+            return id;
+        }
+    }
+
+    uint8_t peekId() {
+        for (;;) {
+            if (p >= end) {
+                throw std::runtime_error("Unexpected end of binary JSON data");
+            }
+            if (*p == JID_KEY_SEPARATOR || *p == JID_VALUE_SEPARATOR) {
+                p++;
+                continue;
+            }
+            if (*p == JID_TOKENUNDEF) {
+                p++;
+                tokens.erase(readLength());
+                continue;
+            }
+            return *p;
+        }
+    }
+
+    std::string parseStringToken(uint8_t id) {
+        if (id == JID_STRING) {
+            return readRawString();
+        }
+        if (id == JID_TOKENDEF) {
+            uint64_t key = readLength();
+            std::string s = readRawString();
+            tokens[key] = s;
+            return s;
+        }
+        if (id == JID_TOKENREF) {
+            auto it = tokens.find(readLength());
+            if (it == tokens.end()) {
+                throw std::runtime_error("Undefined token reference in binary JSON");
+            }
+            return it->second;
+        }
+        throw std::runtime_error("Expected string in binary JSON");
+    }
+
+    template <class T>
+    void readUniform(nlohmann::json& arr, uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            arr.push_back(readPod<T>());
+        }
+    }
+
+    nlohmann::json parseUniformArray() {
+        uint8_t type = readPod<uint8_t>();
+        uint64_t n = readLength();
+        nlohmann::json arr = nlohmann::json::array();
+        switch (type) {
+            case JID_INT8: readUniform<int8_t>(arr, n); break;
+            case JID_INT16: readUniform<int16_t>(arr, n); break;
+            case JID_INT32: readUniform<int32_t>(arr, n); break;
+            case JID_INT64: readUniform<int64_t>(arr, n); break;
+            case JID_UINT8: readUniform<uint8_t>(arr, n); break;
+            case JID_UINT16: readUniform<uint16_t>(arr, n); break;
+            case JID_REAL32: readUniform<float>(arr, n); break;
+            case JID_REAL64: readUniform<double>(arr, n); break;
+            case JID_REAL16:
+                for (uint64_t i = 0; i < n; i++) arr.push_back(halfToFloat(readPod<uint16_t>()));
+                break;
+            case JID_BOOL: {
+                // 按32位字打包
+                uint32_t word = 0;
+                for (uint64_t i = 0; i < n; i++) {
+                    if (i % 32 == 0) word = readPod<uint32_t>();
+                    arr.push_back(((word >> (i % 32)) & 1) != 0);
+                }
+                break;
+            }
+            default:
+                throw std::runtime_error("Unsupported uniform array type in binary JSON: " + std::to_string(type));
+        }
+        return arr;
+    }
+
+    nlohmann::json parseValue(uint8_t id) {
+        switch (id) {
+            case JID_NULL: return nullptr;
+            case JID_FALSE: return false;
+            case JID_TRUE: return true;
+            case JID_BOOL: return readPod<uint8_t>() != 0;
+            case JID_INT8: return readPod<int8_t>();
+            case JID_INT16: return readPod<int16_t>();
+            case JID_INT32: return readPod<int32_t>();
+            case JID_INT64: return readPod<int64_t>();
+            case JID_UINT8: return readPod<uint8_t>();
+            case JID_UINT16: return readPod<uint16_t>();
+            case JID_REAL16: return halfToFloat(readPod<uint16_t>());
+            case JID_REAL32: return readPod<float>();
+            case JID_REAL64: return readPod<double>();
+            case JID_STRING:
+            case JID_TOKENDEF:
+            case JID_TOKENREF:
+                return parseStringToken(id);
+            case JID_UNIFORM_ARRAY: return parseUniformArray();
+            case JID_ARRAY_BEGIN: {
+                nlohmann::json arr = nlohmann::json::array();
+                while (peekId() != JID_ARRAY_END) {
+                    arr.push_back(parseValue(nextId()));
+                }
+                p++;
+                return arr;
+            }
+            case JID_MAP_BEGIN: {
+                nlohmann::json obj = nlohmann::json::object();
+                while (peekId() != JID_MAP_END) {
+                    std::string key = parseStringToken(nextId());
+                    obj[key] = parseValue(nextId());
+                }
+                p++;
+                return obj;
+            }
+            default:
+                throw std::runtime_error("Unknown binary JSON token: " + std::to_string(id));
+        }
+    }
+
+    const uint8_t* p;
+    const uint8_t* end;
+    std::unordered_map<uint64_t, std::string> tokens;
+};
+
+} // namespace
+
+
+void appendMagic(std::string& out) {
+    out.push_back(static_cast<char>(JID_MAGIC));
+    appendPod<uint32_t>(out, BINARY_MAGIC);
+}
+
+void appendValue(std::string& out, const nlohmann::json& value) {
+    switch (value.type()) {
+        case nlohmann::json::value_t::null:
+            out.push_back(static_cast<char>(JID_NULL));
+            break;
+        case nlohmann::json::value_t::boolean:
+            out.push_back(static_cast<char>(value.get<bool>() ? JID_TRUE : JID_FALSE));
+            break;
+        case nlohmann::json::value_t::number_integer:
+        case nlohmann::json::value_t::number_unsigned: {
+            if (value.is_number_unsigned() && value.get<uint64_t>() > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                out.push_back(static_cast<char>(JID_REAL64));
+                appendPod<double>(out, value.get<double>());
+                break;
+            }
+            int64_t v = asInt64(value);
+            uint8_t type = intTypeFor(v, v);
+            out.push_back(static_cast<char>(type));
+            appendInt(out, type, v);
+            break;
+        }
+        case nlohmann::json::value_t::number_float: {
+            double v = value.get<double>();
+            if (isExactFloat(v)) {
+                out.push_back(static_cast<char>(JID_REAL32));
+                appendPod<float>(out, static_cast<float>(v));
+            }
+            else {
+                out.push_back(static_cast<char>(JID_REAL64));
+                appendPod<double>(out, v);
+            }
+            break;
+        }
+        case nlohmann::json::value_t::string:
+            appendString(out, value.get_ref<const std::string&>());
+            break;
+        case nlohmann::json::value_t::array:
+            if (!appendUniformArray(out, value)) {
+                out.push_back(static_cast<char>(JID_ARRAY_BEGIN));
+                for (const auto& v : value) {
+                    appendValue(out, v);
+                }
+                out.push_back(static_cast<char>(JID_ARRAY_END));
+            }
+            break;
+        case nlohmann::json::value_t::object:
+            out.push_back(static_cast<char>(JID_MAP_BEGIN));
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                appendString(out, it.key());
+                appendValue(out, it.value());
+            }
+            out.push_back(static_cast<char>(JID_MAP_END));
+            break;
+        default:
+            throw std::runtime_error("Unsupported JSON value for binary geo output");
+    }
+}
+
+void appendArrayBegin(std::string& out) {
+    out.push_back(static_cast<char>(JID_ARRAY_BEGIN));
+}
+
+void appendArrayEnd(std::string& out) {
+    out.push_back(static_cast<char>(JID_ARRAY_END));
+}
+
+std::string encode(const nlohmann::json& doc) {
+    std::string out;
+    appendMagic(out);
+    appendValue(out, doc);
+    return out;
+}
+
+nlohmann::json decode(const char* data, size_t size) {
+    Decoder decoder(data, size);
+    return decoder.parseDocument();
+}
+
+bool hasMagic(const char* data, size_t size) {
+    return size >= 1 && static_cast<uint8_t>(data[0]) == JID_MAGIC;
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include "json.hpp"
+
+// Houdini二进制JSON (.bgeo) 的编码和解码。
+// 格式参考 https://www.sidefx.com/docs/houdini/io/formats/geo.html 中的 binary JSON 一节。
+namespace HoudiniGeoBinary {
+
+// 文件头：0x7f + "NSJb"
+void appendMagic(std::string& out);
+
+// 把一个JSON值编码追加到out。纯数字数组写成uniform array。
+void appendValue(std::string& out, const nlohmann::json& value);
+
+// 分段拼接数组时使用
+void appendArrayBegin(std::string& out);
+void appendArrayEnd(std::string& out);
+
+// 编码整个文档（包含文件头）
+std::string encode(const nlohmann::json& doc);
+
+// 解码二进制JSON，支持Houdini写出的token定义/引用和uniform array。
+nlohmann::json decode(const char* data, size_t size);
+
+bool hasMagic(const char* data, size_t size);
+
+}
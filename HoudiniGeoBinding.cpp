@@ -0,0 +1,32 @@
+#include "HoudiniGeoBinding.h"
+#include "HoudiniGeoIO.h"
+#include <cstdlib>
+
+
+void GeoAttributeSource::load(const std::string& path) {
+    filePath = path;
+    text = HoudiniGeoIO::loadAsText(path);
+    if (!HoudiniGeoScan::scanTopLevel(text.data(), text.size(), sections)) {
+        throw std::runtime_error("Not a geo file: " + path);
+    }
+    auto countOf = [&](const char* key) -> size_t {
+        const HoudiniGeoScan::Section* section = HoudiniGeoScan::findSection(sections, key);
+        return section ? std::strtoull(text.data() + section->value.begin, nullptr, 10) : 0;
+    };
+    pointCount = countOf("pointcount");
+    primitiveCount = countOf("primitivecount");
+
+    const HoudiniGeoScan::Section* section = HoudiniGeoScan::findSection(sections, "attributes");
+    hasAttributes = section != nullptr;
+    if (hasAttributes) {
+        attributes = section->value;
+    }
+}
+
+bool GeoAttributeSource::find(GeoAttributeClass attributeClass, const char* name, HoudiniGeoScan::Range& values, int& tupleSize) const {
+    if (!hasAttributes) {
+        return false;
+    }
+    const char* key = attributeClass == GeoAttributeClass::Point ? "pointattributes" : "primitiveattributes";
+    return HoudiniGeoScan::findAttribute(text.data(), attributes, key, name, values, tupleSize);
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Dense>
+#include "HoudiniGeoScan.h"
+
+
+// 编译期绑定固定的属性表到用户结构体的列：
+//
+//   struct SimState {
+//       std::vector<Eigen::Vector3d> P;
+//       std::vector<float> mass;
+//       std::vector<int> gluetoanimation;
+//       std::vector<double> stiffness;   // 每个四面体一个
+//   };
+//   auto binding = makeGeoBinding(
+//       geoPointAttribute("P", &SimState::P),
+//       geoPointAttribute("mass", &SimState::mass),
+//       geoPointAttribute("gluetoanimation", &SimState::gluetoanimation, false),  // 可选
+//       geoPrimitiveAttribute("stiffness", &SimState::stiffness));
+//   SimState state;
+//   binding.read("input.geo", state);
+//
+// 每一列的元素类型在编译期决定分量数和标量类型（double/float/int），读取时按绑定逐个展开，
+// 直接把数字解析进列的内存，没有字符串到json的map，也没有逐值的类型分派。
+
+enum class GeoAttributeClass { Point, Primitive };
+
+// 列元素类型 -> (标量类型, 分量数)
+template<class T>
+struct GeoColumnTraits {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, float>::value || std::is_same<T, int>::value,
+                  "Column element must be double, float, int, std::array of them or a fixed-size Eigen vector");
+    using Scalar = T;
+    static constexpr int components = 1;
+};
+
+template<class S, size_t N>
+struct GeoColumnTraits<std::array<S, N>> {
+    using Scalar = typename GeoColumnTraits<S>::Scalar;
+    static constexpr int components = static_cast<int>(N);
+};
+
+template<class S, int N, int Options, int MaxRows>
+struct GeoColumnTraits<Eigen::Matrix<S, N, 1, Options, MaxRows, 1>> {
+    static_assert(N > 0, "Eigen column must have a fixed size");
+    using Scalar = typename GeoColumnTraits<S>::Scalar;
+    static constexpr int components = N;
+};
+
+template<class Owner, class Element>
+struct GeoAttributeBinding {
+    const char* name;
+    GeoAttributeClass attributeClass;
+    std::vector<Element> Owner::* column;
+    bool required;
+};
+
+template<class Owner, class Element>
+constexpr GeoAttributeBinding<Owner, Element> geoPointAttribute(const char* name, std::vector<Element> Owner::* column, bool required = true) {
+    return {name, GeoAttributeClass::Point, column, required};
+}
+
+template<class Owner, class Element>
+constexpr GeoAttributeBinding<Owner, Element> geoPrimitiveAttribute(const char* name, std::vector<Element> Owner::* column, bool required = true) {
+    return {name, GeoAttributeClass::Primitive, column, required};
+}
+
+
+// 读入的文件：文本形式、顶层各段的范围和点数/图元数。非模板部分，在HoudiniGeoBinding.cpp中实现。
+class GeoAttributeSource {
+public:
+    void load(const std::string& filePath);
+
+    size_t count(GeoAttributeClass attributeClass) const {
+        return attributeClass == GeoAttributeClass::Point ? pointCount : primitiveCount;
+    }
+    bool find(GeoAttributeClass attributeClass, const char* name, HoudiniGeoScan::Range& values, int& tupleSize) const;
+    const char* data() const { return text.data(); }
+    const std::string& path() const { return filePath; }
+
+private:
+    std::string filePath;
+    std::string text;
+    std::vector<HoudiniGeoScan::Section> sections;
+    HoudiniGeoScan::Range attributes;
+    bool hasAttributes = false;
+    size_t pointCount = 0;
+    size_t primitiveCount = 0;
+};
+
+
+template<class Owner, class... Elements>
+class HoudiniGeoBinding {
+public:
+    explicit HoudiniGeoBinding(GeoAttributeBinding<Owner, Elements>... bindings) : bindings(bindings...) {}
+
+    // 读取全部绑定的列。必需的属性不存在、或分量数与列类型不符时抛出异常；可选的属性不存在时该列清空。
+    void read(const std::string& filePath, Owner& out) {
+        source.load(filePath);
+        std::apply([&](const auto&... binding) { (readColumn(binding, out), ...); }, bindings);
+    }
+
+private:
+    template<class Element>
+    void readColumn(const GeoAttributeBinding<Owner, Element>& binding, Owner& out) {
+        using Traits = GeoColumnTraits<Element>;
+        using Scalar = typename Traits::Scalar;
+        static_assert(sizeof(Element) == sizeof(Scalar) * Traits::components, "Column element must be tightly packed");
+
+        std::vector<Element>& column = out.*(binding.column);
+        HoudiniGeoScan::Range values;
+        int tupleSize = 0;
+        if (!source.find(binding.attributeClass, binding.name, values, tupleSize)) {
+            if (binding.required) {
+                throw std::runtime_error(std::string("No attribute named ") + binding.name + "\nFile: " + source.path());
+            }
+            column.clear();
+            return;
+        }
+        if (tupleSize != Traits::components) {
+            throw std::runtime_error(std::string("Attribute ") + binding.name + " has " + std::to_string(tupleSize) +
+                                     " components, column expects " + std::to_string(Traits::components) +
+                                     "\nFile: " + source.path());
+        }
+
+        const size_t n = source.count(binding.attributeClass);
+        column.resize(n);
+        const size_t total = n * Traits::components;
+        HoudiniGeoScan::NumberReader reader(source.data(), values);
+        if (reader.read(reinterpret_cast<Scalar*>(column.data()), total) != total) {
+            throw std::runtime_error(std::string("Attribute ") + binding.name + " has fewer values than expected" +
+                                     "\nFile: " + source.path());
+        }
+    }
+
+    std::tuple<GeoAttributeBinding<Owner, Elements>...> bindings;
+    GeoAttributeSource source;
+};
+
+template<class Owner, class... Elements>
+HoudiniGeoBinding<Owner, Elements...> makeGeoBinding(GeoAttributeBinding<Owner, Elements>... bindings) {
+    return HoudiniGeoBinding<Owner, Elements...>(bindings...);
+}
@@ -0,0 +1,239 @@
+#include "HoudiniGeoGzip.h"
+#include "HoudiniGeoParallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#ifdef HOUDINIGEOIO_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace HoudiniGeoGzip {
+
+#ifdef HOUDINIGEOIO_WITH_ZLIB
+
+namespace {
+
+const size_t DICT_SIZE = 32768;
+
+void appendLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+}
+
+// 单块raw deflate。非最后一块以Z_SYNC_FLUSH结尾（字节对齐，可以直接拼接），最后一块Z_FINISH。
+std::string deflateChunk(const char* data, size_t size, const char* dict, size_t dictSize, bool last, int level) {
+    z_stream zs{};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2 failed");
+    }
+    if (dictSize > 0) {
+        deflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(dict), static_cast<uInt>(dictSize));
+    }
+
+    std::string out(deflateBound(&zs, static_cast<uLong>(size)) + 16, '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = static_cast<uInt>(size);
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    size_t produced = out.size() - zs.avail_out;
+    deflateEnd(&zs);
+    if ((last && ret != Z_STREAM_END) || (!last && ret != Z_OK) || zs.avail_in != 0) {
+        throw std::runtime_error("deflate failed");
+    }
+    out.resize(produced);
+    return out;
+}
+
+}
+
+bool available() {
+    return true;
+}
+
+std::string compress(const std::string& data, int level, size_t chunkSize) {
+    if (chunkSize == 0) {
+        chunkSize = DEFAULT_CHUNK_SIZE;
+    }
+    const size_t numChunks = std::max<size_t>(1, (data.size() + chunkSize - 1) / chunkSize);
+    std::vector<std::string> chunks(numChunks);
+    std::vector<uLong> crcs(numChunks);
+
+    HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            size_t offset = i * chunkSize;
+            size_t size = std::min(chunkSize, data.size() - offset);
+            size_t dictSize = std::min(offset, DICT_SIZE);
+            chunks[i] = deflateChunk(data.data() + offset, size, data.data() + offset - dictSize, dictSize, i + 1 == numChunks, level);
+            crcs[i] = crc32(0L, reinterpret_cast<const Bytef*>(data.data() + offset), static_cast<uInt>(size));
+        }
+    });
+
+    uLong crc = crcs[0];
+    for (size_t i = 1; i < numChunks; i++) {
+        size_t size = std::min(chunkSize, data.size() - i * chunkSize);
+        crc = crc32_combine(crc, crcs[i], static_cast<z_off_t>(size));
+    }
+
+    size_t total = 18;
+    for (const auto& c : chunks) total += c.size();
+    std::string out;
+    out.reserve(total);
+    // gzip头：magic, deflate, 无flag, mtime=0, xfl=0, OS=unknown
+    const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    out.append(header, 10);
+    for (const auto& c : chunks) out += c;
+    appendLE32(out, static_cast<uint32_t>(crc));
+    appendLE32(out, static_cast<uint32_t>(data.size() & 0xffffffffu));
+    return out;
+}
+
+std::string decompress(std::istream& source) {
+    InputStreambuf buf(source);
+    std::istream in(&buf);
+    std::string out((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (in.bad()) {
+        throw std::runtime_error("gzip decompression failed");
+    }
+    return out;
+}
+
+
+InputStreambuf::InputStreambuf(std::istream& source, size_t blockSize, size_t maxBlocks)
+    : source(source), blockSize(std::max<size_t>(blockSize, 4096)), maxBlocks(std::max<size_t>(maxBlocks, 1)) {
+    worker = std::thread([this] { inflateLoop(); });
+}
+
+InputStreambuf::~InputStreambuf() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+InputStreambuf::int_type InputStreambuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !ready.empty() || finished; });
+    if (ready.empty()) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return traits_type::eof();
+    }
+    current = std::move(ready.front());
+    ready.pop_front();
+    lock.unlock();
+    changed.notify_all();
+
+    char* begin = &current[0];
+    setg(begin, begin, begin + current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+void InputStreambuf::inflateLoop() {
+    z_stream zs{};
+    // 15+32：自动识别gzip/zlib头
+    if (inflateInit2(&zs, 15 + 32) != Z_OK) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::make_exception_ptr(std::runtime_error("inflateInit2 failed"));
+        finished = true;
+        changed.notify_all();
+        return;
+    }
+
+    std::vector<char> in(blockSize);
+    bool streamEnded = false;
+    try {
+        for (;;) {
+            if (zs.avail_in == 0) {
+                source.read(in.data(), static_cast<std::streamsize>(in.size()));
+                size_t n = static_cast<size_t>(source.gcount());
+                if (n == 0) {
+                    if (!streamEnded) {
+                        throw std::runtime_error("Truncated gzip stream");
+                    }
+                    break;
+                }
+                zs.next_in = reinterpret_cast<Bytef*>(in.data());
+                zs.avail_in = static_cast<uInt>(n);
+            }
+            if (streamEnded) {
+                // 多member的gzip文件（例如pigz或cat拼接的）
+                inflateReset(&zs);
+                streamEnded = false;
+            }
+
+            std::string out(blockSize, '\0');
+            zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+            zs.avail_out = static_cast<uInt>(out.size());
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                streamEnded = true;
+            }
+            else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                throw std::runtime_error(std::string("gzip data error: ") + (zs.msg ? zs.msg : "unknown"));
+            }
+            out.resize(out.size() - zs.avail_out);
+
+            if (!out.empty()) {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this] { return ready.size() < maxBlocks || stopping; });
+                if (stopping) break;
+                ready.push_back(std::move(out));
+                lock.unlock();
+                changed.notify_all();
+            }
+            else {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) break;
+            }
+        }
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+    }
+    inflateEnd(&zs);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    changed.notify_all();
+}
+
+#else
+
+bool available() {
+    return false;
+}
+
+std::string compress(const std::string&, int, size_t) {
+    throw std::runtime_error("HoudiniGeoIO was built without zlib, .gz output is not available");
+}
+
+std::string decompress(std::istream&) {
+    throw std::runtime_error("HoudiniGeoIO was built without zlib, .gz input is not available");
+}
+
+InputStreambuf::InputStreambuf(std::istream& source, size_t blockSize, size_t maxBlocks)
+    : source(source), blockSize(blockSize), maxBlocks(maxBlocks) {
+    throw std::runtime_error("HoudiniGeoIO was built without zlib, .gz input is not available");
+}
+
+InputStreambuf::~InputStreambuf() {}
+
+InputStreambuf::int_type InputStreambuf::underflow() {
+    return traits_type::eof();
+}
+
+void InputStreambuf::inflateLoop() {}
+
+#endif
+
+}
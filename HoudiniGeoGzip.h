@@ -0,0 +1,56 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+// .geo.gz / .bgeo.gz 支持，需要zlib（定义 HOUDINIGEOIO_WITH_ZLIB 并链接zlib）。
+namespace HoudiniGeoGzip {
+
+const size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+// 编译时是否带了zlib
+bool available();
+
+// 仿pigz的并行压缩：数据切成独立的块，在线程池上分别deflate（以前一块末尾32KB作字典），
+// 拼接成单个gzip member，CRC由各块的CRC合并得到。输出可被任何gzip解压器读取。
+std::string compress(const std::string& data, int level = 6, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+// 一次性解压到内存（支持多member）
+std::string decompress(std::istream& source);
+
+// 流式解压：后台线程从source读取并按块inflate，解析线程通过这个streambuf按块取数据，
+// 两者重叠进行。最多缓存maxBlocks个解压好的块。
+class InputStreambuf : public std::streambuf {
+public:
+    explicit InputStreambuf(std::istream& source, size_t blockSize = DEFAULT_CHUNK_SIZE, size_t maxBlocks = 4);
+    ~InputStreambuf() override;
+
+    InputStreambuf(const InputStreambuf&) = delete;
+    InputStreambuf& operator=(const InputStreambuf&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    void inflateLoop();
+
+    std::istream& source;
+    const size_t blockSize;
+    const size_t maxBlocks;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::string> ready;
+    std::string current;
+    bool finished = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread worker;
+};
+
+}
@@ -2,10 +2,19 @@
 
 
 #include "HoudiniGeoIO.h"
+#include "HoudiniGeoBinary.h"
+#include "HoudiniGeoGzip.h"
+#include "HoudiniGeoScan.h"
 #include <fstream>
 #include <filesystem>
 #include <iostream>  // 添加这一行
 #include <regex>     // 添加这一行以支持 std::smatch
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #include "HoudiniGeoIO.h"
 
 
@@ -17,14 +26,18 @@ HoudiniGeoIO::HoudiniGeoIO(const std::string& input) {
 }
 
 void HoudiniGeoIO::read(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file: " + filePath);
-    }
+    std::ifstream localFile;
+    std::istream& file = openInput(filePath, localFile);
 
     try {
-        // 从文件读取JSON数据
-        raw = nlohmann::json::parse(file);
+        // 从文件读取JSON数据。拓扑与上一帧相同时只解析变化的属性
+        if (loadGeoFile(file, filePath, 0)) {
+            std::cout << "Finish reading geo file (topology reused): " << filePath << std::endl;
+            return;
+        }
+        rawVersion++;
+        tetWriteTopologyValid = false;
+        info = nlohmann::json();
         
         // 遍历键值对并设置属性
         for (size_t i = 0; i < raw.size(); i += 2) {
@@ -39,6 +52,7 @@ void HoudiniGeoIO::read(const std::string& filePath) {
             else if (name == "primitivecount") primitiveCount = item;
             else if (name == "topology") topology = item;
             else if (name == "attributes") attributes = item;
+            else if (name == "info") info = item;
         }
 
         // 处理拓扑结构
@@ -55,6 +69,8 @@ void HoudiniGeoIO::read(const std::string& filePath) {
         parseVert();
         parsePointAttributes();
         // parsePrimAttributes();
+        parsedTopologyHash = fileTopologyHash;
+        parsedTopologyMode = fileTopologyHashValid ? 0 : -1;
 
         std::cout << "Finish reading geo file: " << filePath << std::endl;
     }
@@ -68,6 +84,384 @@ void HoudiniGeoIO::read(const std::string& filePath) {
     }
 }
 
+GeoFileFormat HoudiniGeoIO::formatFromPath(const std::string& filePath) {
+    auto endsWith = [&](const std::string& ext) {
+        return filePath.size() >= ext.size() &&
+               filePath.compare(filePath.size() - ext.size(), ext.size(), ext) == 0;
+    };
+    // Houdini的.sc容器（带索引的Blosc分块）没有实现
+    if (endsWith(".sc")) {
+        throw std::runtime_error("Houdini .sc compressed files are not supported, use .bgeo or .bgeo.gz: " + filePath);
+    }
+    if (endsWith(".bgeo.gz")) return GeoFileFormat::BinaryGzip;
+    if (endsWith(".gz")) return GeoFileFormat::AsciiGzip;
+    if (endsWith(".bgeo")) return GeoFileFormat::Binary;
+    return GeoFileFormat::Ascii;
+}
+
+// 复用模式下使用成员文件流和固定的流缓冲区，否则打开local
+std::istream& HoudiniGeoIO::openInput(const std::string& filePath, std::ifstream& local) {
+    std::ifstream& file = reuseBuffers ? reusedInput.stream : local;
+    if (file.is_open()) {
+        file.close();
+    }
+    file.clear();
+    if (reuseBuffers) {
+        if (reusedInput.buffer.empty()) {
+            reusedInput.buffer.resize(1 << 16);
+        }
+        file.rdbuf()->pubsetbuf(reusedInput.buffer.data(), static_cast<std::streamsize>(reusedInput.buffer.size()));
+    }
+    file.open(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filePath);
+    }
+    return file;
+}
+
+// 把整个文件读进fileBuffer
+void HoudiniGeoIO::readFileBuffer(std::istream& file) {
+    file.seekg(0, std::ios::end);
+    const std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+    const size_t bytes = fileSize > 0 ? static_cast<size_t>(fileSize) : 0;
+    if (reuseBuffers && fileBuffer.capacity() < bytes) {
+        fileBuffer.reserve(bytes + bytes / 16);  // 留余量，后面的帧稍大时不必重新分配
+    }
+    fileBuffer.resize(bytes);
+    if (!fileBuffer.empty() && !file.read(&fileBuffer[0], static_cast<std::streamsize>(fileBuffer.size()))) {
+        throw std::runtime_error("Failed to read file");
+    }
+}
+
+// 读入raw，返回true表示拓扑与上一帧相同、已经只解析了变化的段。
+// 文本文件整体读进fileBuffer后扫描顶层各段，对拓扑相关段的字节做哈希（不解析），
+// 哈希与当前已解析的拓扑一致时只解析info和attributes；否则从fileBuffer完整解析。
+bool HoudiniGeoIO::loadGeoFile(std::istream& file, const std::string& filePath, int mode) {
+    static const char* topologyKeys[] = {
+        "pointcount", "vertexcount", "primitivecount", "topology", "primitives", "pointgroups", "primitivegroups",
+    };
+    const int previousMode = parsedTopologyMode;
+    parsedTopologyMode = -1;  // 解析成功后才重新置为有效
+    rawPointOrderValid = true;
+    reusedTopology = false;
+    fileTopologyHashValid = false;
+
+    if (formatFromPath(filePath) != GeoFileFormat::Ascii) {
+        raw = parseGeoFile(file, filePath);
+        return false;
+    }
+
+    readFileBuffer(file);
+
+    if (HoudiniGeoScan::scanTopLevel(fileBuffer.data(), fileBuffer.size(), fileSections)) {
+        uint64_t h = 0;
+        for (const char* key : topologyKeys) {
+            const HoudiniGeoScan::Section* section = HoudiniGeoScan::findSection(fileSections, key);
+            if (section != nullptr) {
+                h = HoudiniGeoHash(section->key.data(), section->key.size(), h);
+                h = HoudiniGeoHash(fileBuffer.data() + section->value.begin, section->value.size(), h);
+            }
+        }
+        fileTopologyHash = h;
+        fileTopologyHashValid = true;
+
+        if (previousMode == mode && parsedTopologyHash == fileTopologyHash && raw.is_array()) {
+            parseVaryingSections(mode);
+            parsedTopologyMode = mode;
+            reusedTopology = true;
+            return true;
+        }
+    }
+
+    if (reuseBuffers && keyScratch.capacity() < 256) {
+        keyScratch.reserve(256);  // 对象的键都很短，完整解析时预留好，之后就地更新不再分配
+    }
+    raw = nlohmann::json::parse(fileBuffer.begin(), fileBuffer.end());
+    return false;
+}
+
+// 拓扑复用时只解析info和attributes，并替换raw中对应的段，保证write()输出的是新的一帧
+void HoudiniGeoIO::parseVaryingSections(int mode) {
+    if (reuseBuffers && updateVaryingSectionsInPlace()) {
+        return;
+    }
+    for (const char* key : {"info", "attributes"}) {
+        const HoudiniGeoScan::Section* section = HoudiniGeoScan::findSection(fileSections, key);
+        if (section == nullptr) continue;
+        nlohmann::json value = nlohmann::json::parse(fileBuffer.begin() + section->value.begin,
+                                                     fileBuffer.begin() + section->value.end);
+        for (size_t i = 0; i + 1 < raw.size(); i += 2) {
+            if (raw[i] == key) {
+                raw[i + 1] = std::move(value);
+                if (std::strcmp(key, "info") == 0) info = raw[i + 1];
+                else attributes = pairListToDict(raw[i + 1]);
+                break;
+            }
+        }
+    }
+    if (mode == 1) parsePointAttributes_TetWithSurface();
+    else parsePointAttributes();
+}
+
+// 复用模式：按文本就地更新raw中的info和attributes以及info成员，再从raw的P刷新positions，不分配内存。
+// 结构不一致时返回false，由调用方完整解析这两段（此时raw可能已被部分改写，会被整体替换）。
+// attributes成员只在解析时使用，这里不更新。
+bool HoudiniGeoIO::updateVaryingSectionsInPlace() {
+    for (const char* key : {"info", "attributes"}) {
+        const HoudiniGeoScan::Section* section = HoudiniGeoScan::findSection(fileSections, key);
+        if (section == nullptr) continue;
+        bool found = false;
+        for (size_t i = 0; i + 1 < raw.size(); i += 2) {
+            if (raw[i].is_string() && raw[i].get_ref<const std::string&>() == key) {
+                if (!HoudiniGeoScan::updateInPlace(fileBuffer.data(), fileBuffer.size(), section->value, raw[i + 1], keyScratch)) {
+                    return false;
+                }
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        if (std::strcmp(key, "info") == 0 &&
+            !HoudiniGeoScan::updateInPlace(fileBuffer.data(), fileBuffer.size(), section->value, info, keyScratch)) {
+            return false;
+        }
+    }
+
+    const nlohmann::json* tuples = findPositionTuples(raw);
+    if (tuples == nullptr || tuples->size() != static_cast<size_t>(pointCount)) {
+        return false;
+    }
+    positions.resize(tuples->size() * 3);
+    for (size_t i = 0; i < tuples->size(); i++) {
+        const auto& point = (*tuples)[i];
+        if (!point.is_array() || point.size() != 3) {
+            return false;
+        }
+        positions[i * 3 + 0] = point[0].get<double>();
+        positions[i * 3 + 1] = point[1].get<double>();
+        positions[i * 3 + 2] = point[2].get<double>();
+    }
+    return true;
+}
+
+namespace {
+
+template<class T>
+void readNumbers(const char* data, HoudiniGeoScan::Range range, T* out, size_t count, const char* what) {
+    HoudiniGeoScan::NumberReader reader(data, range);
+    if (reader.read(out, count) != count) {
+        throw std::runtime_error(std::string(what) + " has fewer values than expected");
+    }
+}
+
+}
+
+GeoReadSizes HoudiniGeoIO::readInto(const std::string& filePath, const GeoReadTargets& targets) {
+    std::ifstream localFile;
+    std::istream& file = openInput(filePath, localFile);
+
+    try {
+        if (formatFromPath(filePath) == GeoFileFormat::Ascii) {
+            readFileBuffer(file);
+        }
+        else {
+            fileBuffer = parseGeoFile(file, filePath).dump();
+        }
+        const char* data = fileBuffer.data();
+        if (!HoudiniGeoScan::scanTopLevel(data, fileBuffer.size(), fileSections)) {
+            throw std::runtime_error("Not a geo file");
+        }
+        auto section = [&](const char* key) {
+            const HoudiniGeoScan::Section* s = HoudiniGeoScan::findSection(fileSections, key);
+            if (s == nullptr) {
+                throw std::runtime_error(std::string("Missing section: ") + key);
+            }
+            return s->value;
+        };
+
+        GeoReadSizes sizes;
+        sizes.pointCount = std::strtoull(data + section("pointcount").begin, nullptr, 10);
+        sizes.vertexCount = std::strtoull(data + section("vertexcount").begin, nullptr, 10);
+
+        // 图元run只有几个元素，用DOM解析。记录每个run每个图元的顶点数（0表示不支持的类型）和图元数
+        std::vector<std::pair<size_t, size_t>> runs;
+        if (const HoudiniGeoScan::Section* prims = HoudiniGeoScan::findSection(fileSections, "primitives")) {
+            const nlohmann::json primitivesJson = nlohmann::json::parse(data + prims->value.begin, data + prims->value.end);
+            for (const auto& run : primitivesJson) {
+                if (!run.is_array() || run.size() < 2 || !run[0].is_array() || run[0].size() < 2) continue;
+                const std::string type = run[0][1].get<std::string>();
+                size_t nprimitives = 0;
+                size_t verticesPerPrim = 0;
+                const auto& attribs = run[1];
+                for (size_t i = 0; i + 1 < attribs.size(); i += 2) {
+                    if (attribs[i] == "nprimitives") {
+                        nprimitives = attribs[i + 1].get<size_t>();
+                    }
+                }
+                if (type == "Tetrahedron_run") {
+                    verticesPerPrim = 4;
+                    sizes.tetCount += nprimitives;
+                }
+                else if (type == "Polygon_run") {
+                    verticesPerPrim = 3;
+                    for (size_t i = 0; i + 1 < attribs.size(); i += 2) {
+                        if (attribs[i] != "nvertices_rle") continue;
+                        const auto& rle = attribs[i + 1];
+                        for (size_t j = 0; j + 1 < rle.size(); j += 2) {
+                            if (rle[j] != 3) verticesPerPrim = 0;
+                        }
+                    }
+                    if (verticesPerPrim == 3) {
+                        sizes.surfaceCount += nprimitives;
+                    }
+                }
+                runs.emplace_back(verticesPerPrim, nprimitives);
+            }
+        }
+
+        // 点属性
+        HoudiniGeoScan::Range values;
+        int tupleSize = 0;
+        if (targets.positions || targets.positionBuffer || !targets.pointAttributes.empty()) {
+            const HoudiniGeoScan::Range attributesRange = section("attributes");
+            if (targets.positions || targets.positionBuffer) {
+                if (!HoudiniGeoScan::findAttribute(data, attributesRange, "pointattributes", "P", values, tupleSize) || tupleSize != 3) {
+                    throw std::runtime_error("No P attribute found in point attributes");
+                }
+            }
+            if (targets.positions) {
+                readNumbers(data, values, targets.positions(sizes.pointCount * 3), sizes.pointCount * 3, "P");
+            }
+            if (GeoPositionBuffer* buffer = targets.positionBuffer) {
+                buffer->resize(sizes.pointCount);
+                if (buffer->layout() == GeoPositionLayout::AoS) {
+                    readNumbers(data, values, buffer->data(), sizes.pointCount * 3, "P");
+                }
+                else {
+                    // 逐点读出xyz，直接写到各分量的位置
+                    HoudiniGeoScan::NumberReader reader(data, values);
+                    double* out = buffer->data();
+                    double xyz[3];
+                    for (size_t i = 0; i < sizes.pointCount; i++) {
+                        if (reader.read(xyz, 3) != 3) {
+                            throw std::runtime_error("P has fewer values than expected");
+                        }
+                        out[buffer->offset(i, 0)] = xyz[0];
+                        out[buffer->offset(i, 1)] = xyz[1];
+                        out[buffer->offset(i, 2)] = xyz[2];
+                    }
+                }
+                buffer->fillPadding();
+            }
+            for (const auto& target : targets.pointAttributes) {
+                if (!HoudiniGeoScan::findAttribute(data, attributesRange, "pointattributes", target.first.c_str(), values, tupleSize)) {
+                    throw std::runtime_error("No point attribute named " + target.first);
+                }
+                const size_t count = sizes.pointCount * static_cast<size_t>(tupleSize);
+                readNumbers(data, values, target.second(sizes.pointCount, tupleSize), count, target.first.c_str());
+            }
+        }
+
+        // 顶点索引：按run的顺序依次属于四面体或三角形
+        if (targets.indices || targets.tetIndices || targets.surfaceIndices) {
+            HoudiniGeoScan::Range pointRefRange, indicesRange;
+            if (!HoudiniGeoScan::findPairValue(data, section("topology"), "pointref", pointRefRange) ||
+                !HoudiniGeoScan::findPairValue(data, pointRefRange, "indices", indicesRange)) {
+                throw std::runtime_error("No pointref indices found in topology");
+            }
+            int* all = targets.indices ? targets.indices(sizes.vertexCount) : nullptr;
+            int* tets = targets.tetIndices ? targets.tetIndices(sizes.tetCount * 4) : nullptr;
+            int* tris = targets.surfaceIndices ? targets.surfaceIndices(sizes.surfaceCount * 3) : nullptr;
+
+            HoudiniGeoScan::NumberReader reader(data, indicesRange);
+            if (all != nullptr) {
+                if (reader.read(all, sizes.vertexCount) != sizes.vertexCount) {
+                    throw std::runtime_error("pointref indices has fewer values than vertexcount");
+                }
+            }
+            if (tets != nullptr || tris != nullptr) {
+                size_t vertex = 0;
+                for (const auto& run : runs) {
+                    const size_t count = run.first * run.second;
+                    int* dst = nullptr;
+                    if (run.first == 4) { dst = tets; if (tets) tets += count; }
+                    else if (run.first == 3) { dst = tris; if (tris) tris += count; }
+                    else if (run.first == 0) {
+                        throw std::runtime_error("Only Tetrahedron_run and triangle Polygon_run primitives are supported");
+                    }
+
+                    if (dst == nullptr) {
+                        if (all == nullptr && reader.skip(count) != count) {
+                            throw std::runtime_error("pointref indices has fewer values than primitives");
+                        }
+                    }
+                    else if (all != nullptr) {
+                        if (vertex + count > sizes.vertexCount) {
+                            throw std::runtime_error("pointref indices has fewer values than primitives");
+                        }
+                        std::memcpy(dst, all + vertex, count * sizeof(int));
+                    }
+                    else if (reader.read(dst, count) != count) {
+                        throw std::runtime_error("pointref indices has fewer values than primitives");
+                    }
+                    vertex += count;
+                }
+            }
+        }
+
+        std::cout << "Finish reading geo file into buffers: " << filePath << std::endl;
+        return sizes;
+    }
+    catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("JSON parsing error: " + std::string(e.what()) +
+                               "\nFile: " + filePath);
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("Error reading file: " + std::string(e.what()) +
+                               "\nFile: " + filePath);
+    }
+}
+
+std::string HoudiniGeoIO::loadAsText(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filePath);
+    }
+    if (formatFromPath(filePath) == GeoFileFormat::Ascii) {
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+    return parseGeoFile(file, filePath).dump();
+}
+
+// 按扩展名解析文件：.geo走nlohmann的文本解析，.bgeo/.bgeo.gz走二进制JSON
+nlohmann::json HoudiniGeoIO::parseGeoFile(std::istream& file, const std::string& filePath) {
+    GeoFileFormat format = formatFromPath(filePath);
+    if (format == GeoFileFormat::Ascii) {
+        return nlohmann::json::parse(file);
+    }
+    if (format == GeoFileFormat::AsciiGzip) {
+        // 后台线程分块解压，与JSON解析重叠
+        HoudiniGeoGzip::InputStreambuf gzbuf(file);
+        std::istream gzstream(&gzbuf);
+        return nlohmann::json::parse(gzstream);
+    }
+
+    std::string bytes;
+    if (format == GeoFileFormat::BinaryGzip) {
+        bytes = HoudiniGeoGzip::decompress(file);
+    }
+    else {
+        bytes.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+    if (!HoudiniGeoBinary::hasMagic(bytes.data(), bytes.size())) {
+        throw std::runtime_error("Not a binary geo file");
+    }
+    return HoudiniGeoBinary::decode(bytes.data(), bytes.size());
+}
+
 std::map<std::string, nlohmann::json> HoudiniGeoIO::pairListToDict(const nlohmann::json& pairs) {
     std::map<std::string, nlohmann::json> result;
     for (size_t i = 0; i < pairs.size(); i += 2) {
@@ -199,18 +593,526 @@ void HoudiniGeoIO::write(const std::string& output) {
         outputPath = p.parent_path().string() + "/" + p.stem().string() + ".geo";
     }
     
-    std::ofstream file(outputPath);
+    std::ofstream file(outputPath, std::ios::binary);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for writing: " + outputPath);
     }
     
-    file << raw.dump();
+    GeoFileFormat format = formatFromPath(outputPath);
+    const bool binary = format == GeoFileFormat::Binary || format == GeoFileFormat::BinaryGzip;
+    std::string bytes = serialize(binary);
+    if (format == GeoFileFormat::AsciiGzip || format == GeoFileFormat::BinaryGzip) {
+        bytes = HoudiniGeoGzip::compress(bytes);
+    }
+    file.write(bytes.data(), bytes.size());
     std::cout << "Finish writing geo file: " << outputPath << std::endl;
 }
 
 
+// 把raw按pair list逐段输出，拓扑相关的段直接拼接缓存的字节
+std::string HoudiniGeoIO::serialize(bool binary) {
+    static const char* cachedKeys[] = {"topology", "primitives", "pointgroups", "primitivegroups"};
+    auto isCachedKey = [](const nlohmann::json& key) {
+        for (const char* k : cachedKeys) {
+            if (key == k) return true;
+        }
+        return false;
+    };
+    auto appendValue = [binary](std::string& out, const nlohmann::json& value) {
+        if (binary) HoudiniGeoBinary::appendValue(out, value);
+        else out += value.dump();
+    };
+
+    const uint64_t fingerprint = topologyFingerprint();
+    if (!topologyCache.valid || topologyCache.binary != binary ||
+        topologyCache.fingerprint != fingerprint || topologyCache.rawVersion != rawVersion) {
+        topologyCache.sections.clear();
+        for (size_t i = 0; i + 1 < raw.size(); i += 2) {
+            if (isCachedKey(raw[i])) {
+                appendValue(topologyCache.sections[raw[i].get<std::string>()], raw[i + 1]);
+            }
+        }
+        topologyCache.valid = true;
+        topologyCache.binary = binary;
+        topologyCache.fingerprint = fingerprint;
+        topologyCache.rawVersion = rawVersion;
+    }
+
+    std::string out;
+    if (binary) {
+        HoudiniGeoBinary::appendMagic(out);
+        HoudiniGeoBinary::appendArrayBegin(out);
+    }
+    else {
+        out += "[";
+    }
+    for (size_t i = 0; i + 1 < raw.size(); i += 2) {
+        if (!binary && i > 0) out += ",";
+        appendValue(out, raw[i]);
+        if (!binary) out += ",";
+        if (isCachedKey(raw[i])) {
+            out += topologyCache.sections[raw[i].get<std::string>()];
+        }
+        else {
+            appendValue(out, raw[i + 1]);
+        }
+    }
+    if (binary) HoudiniGeoBinary::appendArrayEnd(out);
+    else out += "]";
+    return out;
+}
+
+double HoudiniGeoIO::getTime() const {
+    if (info.is_object() && info.contains("time") && info["time"].is_number()) {
+        return info["time"].get<double>();
+    }
+    return 0.0;
+}
+
+bool HoudiniGeoIO::getBounds(double bounds[6]) const {
+    if (!info.is_object() || !info.contains("bounds")) {
+        return false;
+    }
+    const auto& b = info["bounds"];
+    if (!b.is_array() || b.size() != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (!b[i].is_number()) {
+            return false;
+        }
+        bounds[i] = b[i].get<double>();
+    }
+    return true;
+}
+
+uint64_t HoudiniGeoIO::topologyFingerprint() const {
+    uint64_t h = HoudiniGeoHash(indices.data(), indices.size() * sizeof(int), positions.size() / 3);
+    h = HoudiniGeoHash(tet_indices.data(), tet_indices.size() * sizeof(int), h);
+    h = HoudiniGeoHash(surface_indices.data(), surface_indices.size() * sizeof(int), h);
+    h = HoudiniGeoHash(surface_point_bits.data(), surface_point_bits.size() * sizeof(uint64_t), h);
+    return h;
+}
+
+// 按8字节处理的乘法-异或哈希，只用于判断内容是否变化
+uint64_t HoudiniGeoHash(const void* data, size_t size, uint64_t seed) {
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (size * k);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 31;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p + i, size - i);
+    h = (h ^ tail) * k;
+    h ^= h >> 29;
+    return h;
+}
+
 void HoudiniGeoIO::setPositions(const std::vector<double>& pos) {
+    if (pos.size() % 3 != 0) {
+        throw std::runtime_error("Position data size is not a multiple of 3");
+    }
+    if (!positions.empty() && pos.size() != positions.size()) {
+        throw std::runtime_error("Position data size does not match point count");
+    }
+    positions = pos;
+
+    // 同步写回raw中P的tuples，write()直接输出raw
+    nlohmann::json* tuples = findPositionTuples(raw);
+    if (tuples == nullptr) {
+        return;
+    }
+    const size_t n = pos.size() / 3;
+    if (tuples->size() != n) {
+        throw std::runtime_error("Position data size does not match P attribute in file");
+    }
+    for (size_t i = 0; i < n; i++) {
+        auto& point = (*tuples)[i];
+        point[0] = pos[i * 3 + 0];
+        point[1] = pos[i * 3 + 1];
+        point[2] = pos[i * 3 + 2];
+    }
+}
+
+void HoudiniGeoIO::setIsSurfacePoint(const std::vector<bool>& flags) {
+    is_surface_point = flags;
+    parsedTopologyMode = -1;
+    surface_point_bits.assign((flags.size() + 63) / 64, 0);
+    for (size_t i = 0; i < flags.size(); i++) {
+        if (flags[i]) {
+            surface_point_bits[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+}
+
+void HoudiniGeoIO::extractSurface() {
+    std::vector<bool> flags;
+    HoudiniGeoExtractBoundary(tet_indices, positions, surface_indices, &flags);
+    setIsSurfacePoint(flags);
+    surfaceCount = static_cast<int>(surface_indices.size() / 3);
+}
+
+GeoReordering HoudiniGeoIO::reorderSpatially(GeoSpaceFillingCurve curve) {
+    GeoReordering reordering = HoudiniGeoSpatialOrder(positions, tet_indices, surface_indices, curve);
+    applyReordering(reordering);
+    return reordering;
+}
+
+GeoReordering HoudiniGeoIO::reorderBandwidth(GeoBandwidth* bandwidth) {
+    GeoReordering reordering = HoudiniGeoRCMOrder(tet_indices, surface_indices, positions.size() / 3, bandwidth);
+    applyReordering(reordering);
+    return reordering;
+}
+
+GeoReordering HoudiniGeoIO::reorderByComponent(GeoComponents& components) {
+    GeoReordering reordering;
+    HoudiniGeoLabelComponents(tet_indices, surface_indices, positions.size() / 3, components, &reordering);
+    applyReordering(reordering);
+    // 分量编号跟着换成新顺序
+    HoudiniGeoPermute(components.pointComponent, reordering.pointOrder);
+    HoudiniGeoPermute(components.tetComponent, reordering.tetOrder);
+    HoudiniGeoPermute(components.triangleComponent, reordering.triangleOrder);
+    return reordering;
+}
+
+void HoudiniGeoIO::applyReordering(const GeoReordering& reordering) {
+    const size_t npoints = positions.size() / 3;
+    if ((!reordering.pointOrder.empty() && reordering.pointOrder.size() != npoints) ||
+        (!reordering.tetOrder.empty() && reordering.tetOrder.size() != tet_indices.size() / 4) ||
+        (!reordering.triangleOrder.empty() && reordering.triangleOrder.size() != surface_indices.size() / 3)) {
+        throw std::runtime_error("Reordering does not match the geometry");
+    }
+    HoudiniGeoPermute(positions, reordering.pointOrder, 3);
+    HoudiniGeoRemapPrimitives(tet_indices, 4, reordering.tetOrder, reordering.pointRank);
+    HoudiniGeoRemapPrimitives(surface_indices, 3, reordering.triangleOrder, reordering.pointRank);
+    HoudiniGeoRemapPrimitives(indices, 1, {}, reordering.pointRank);
+    if (!is_surface_point.empty()) {
+        std::vector<bool> flags = is_surface_point;
+        HoudiniGeoPermute(flags, reordering.pointOrder);
+        setIsSurfacePoint(flags);
+    }
+    if (!reordering.pointOrder.empty()) {
+        rawPointOrderValid = false;
+    }
+    parsedTopologyMode = -1;
+}
+
+const GeoTetAdjacency& HoudiniGeoIO::getTetAdjacency() {
+    const size_t npoints = positions.size() / 3;
+    const uint64_t key = HoudiniGeoHash(tet_indices.data(), tet_indices.size() * sizeof(int), npoints);
+    if (!tetAdjacencyValid || tetAdjacencyKey != key) {
+        HoudiniGeoBuildTetAdjacency(tet_indices, npoints, tetAdjacency);
+        tetAdjacencyKey = key;
+        tetAdjacencyValid = true;
+    }
+    return tetAdjacency;
+}
+
+void HoudiniGeoIO::validateAfterRead() {
+    if (!validateOnRead) {
+        return;
+    }
+    lastReport = validate();
+    if (!lastReport.ok()) {
+        lastReport.print(std::cerr);
+    }
+}
+
+void HoudiniGeoIO::computeRestState(GeoRestState& out, double density) {
+    HoudiniGeoComputeRestState(tet_indices, positions, density, out, &getTetAdjacency().pointTets);
+}
+
+namespace {
+
+// 与json == "..." 等价，但不构造临时json（不分配内存）
+bool isString(const nlohmann::json& j, const char* s) {
+    return j.is_string() && j.get_ref<const std::string&>() == s;
+}
+
+int countTrailingZeros(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// 把[begin, begin+count)的位全部置1
+void setBitRange(std::vector<uint64_t>& bits, size_t begin, size_t count) {
+    size_t end = begin + count;
+    while (begin < end) {
+        size_t word = begin >> 6;
+        size_t lo = begin & 63;
+        size_t hi = std::min<size_t>(64, lo + (end - begin));
+        uint64_t mask = (hi == 64 ? ~uint64_t(0) : ((uint64_t(1) << hi) - 1)) & (~uint64_t(0) << lo);
+        bits[word] |= mask;
+        begin += hi - lo;
+    }
+}
+
+// 千位分隔，和Houdini的primcount_summary一致，例如 "20,044"
+std::string withThousandsSeparators(size_t n) {
+    std::string digits = std::to_string(n);
+    std::string out;
+    for (size_t i = 0; i < digits.size(); i++) {
+        if (i > 0 && (digits.size() - i) % 3 == 0) out.push_back(',');
+        out.push_back(digits[i]);
+    }
+    return out;
+}
+
+// pair list中key对应的值，没有时返回nullptr
+const nlohmann::json* pairValue(const nlohmann::json& pairs, const char* key) {
+    if (!pairs.is_array()) return nullptr;
+    for (size_t i = 0; i + 1 < pairs.size(); i += 2) {
+        if (isString(pairs[i], key)) return &pairs[i + 1];
+    }
+    return nullptr;
+}
+
+// 属性或组 [metadata, data] 的名字
+bool hasName(const nlohmann::json& item, const char* name) {
+    if (!item.is_array() || item.empty()) return false;
+    const nlohmann::json* value = pairValue(item[0], "name");
+    return value != nullptr && isString(*value, name);
+}
+
+nlohmann::json pointGroup(const std::string& name, nlohmann::json boolRLE) {
+    return nlohmann::json::array({
+        nlohmann::json::array({"name", name}),
+        nlohmann::json::array({"selection", nlohmann::json::array({"unordered", nlohmann::json::array({"boolRLE", std::move(boolRLE)})})}),
+    });
+}
+
+}
+
+// boolRLE [count, value, count, value, ...] 解码为按字打包的位数组，整段run按字填充，返回总位数
+size_t HoudiniGeoIO::decodeBoolRLE(const std::vector<int>& rle, std::vector<uint64_t>& bits) {
+    size_t count = 0;
+    for (size_t i = 0; i < rle.size(); i += 2) {
+        if (rle[i] < 0) {
+            throw std::runtime_error("Negative run length in boolRLE");
+        }
+        count += rle[i];
+    }
+    bits.assign((count + 63) / 64, 0);
+    size_t pos = 0;
+    for (size_t i = 0; i + 1 < rle.size(); i += 2) {
+        if (rle[i + 1]) {
+            setBitRange(bits, pos, rle[i]);
+        }
+        pos += rle[i];
+    }
+    return count;
+}
 
+// 位数组编码为boolRLE。每次跳过整字相同的位，用ctz找到run的结尾。invert为true时输出取反后的组。
+nlohmann::json HoudiniGeoIO::encodeBoolRLE(const std::vector<uint64_t>& bits, size_t count, bool invert) {
+    nlohmann::json rle = nlohmann::json::array();
+    size_t pos = 0;
+    while (pos < count) {
+        bool value = (bits[pos >> 6] >> (pos & 63)) & 1;
+        // 找到第一个与value不同的位
+        const uint64_t flip = value ? ~uint64_t(0) : 0;
+        size_t word = pos >> 6;
+        uint64_t w = (bits[word] ^ flip) & (~uint64_t(0) << (pos & 63));
+        while (w == 0 && ++word < bits.size()) {
+            w = bits[word] ^ flip;
+        }
+        size_t end = (w == 0) ? count : std::min(count, word * 64 + countTrailingZeros(w));
+        rle.push_back(end - pos);
+        rle.push_back(value != invert);
+        pos = end;
+    }
+    return rle;
+}
+
+void HoudiniGeoIO::writeTetWithSurface(const std::string& output) {
+    if (positions.size() % 3 != 0) {
+        throw std::runtime_error("Position data size is not a multiple of 3");
+    }
+    if (tet_indices.size() % 4 != 0 || surface_indices.size() % 3 != 0) {
+        throw std::runtime_error("tet_indices/surface_indices size is not a multiple of 4/3");
+    }
+    const size_t npoints = positions.size() / 3;
+    const size_t ntets = tet_indices.size() / 4;
+    const size_t ntris = surface_indices.size() / 3;
+    if (!is_surface_point.empty() && is_surface_point.size() != npoints) {
+        throw std::runtime_error("is_surface_point size does not match point count");
+    }
+    if (!is_surface_point.empty() && surface_point_bits.size() != (npoints + 63) / 64) {
+        setIsSurfacePoint(is_surface_point);
+    }
+
+    // 拓扑与上次写出时相同：沿用raw里的拓扑段（以及write()缓存的序列化结果），只更新P
+    if (tetWriteTopologyValid && topologyFingerprint() == tetWriteFingerprint) {
+        nlohmann::json* tuples = findPositionTuples(raw);
+        if (tuples != nullptr && tuples->size() == npoints) {
+            for (size_t i = 0; i < npoints; i++) {
+                auto& point = (*tuples)[i];
+                point[0] = positions[i * 3 + 0];
+                point[1] = positions[i * 3 + 1];
+                point[2] = positions[i * 3 + 2];
+            }
+            write(output);
+            return;
+        }
+    }
+
+    // 顶点顺序：先所有四面体，再所有三角形，与readTetWithSurface按primitive run拆分的顺序一致
+    parsedTopologyMode = -1;
+    indices.clear();
+    indices.reserve(tet_indices.size() + surface_indices.size());
+    indices.insert(indices.end(), tet_indices.begin(), tet_indices.end());
+    indices.insert(indices.end(), surface_indices.begin(), surface_indices.end());
+    for (int idx : indices) {
+        if (idx < 0 || static_cast<size_t>(idx) >= npoints) {
+            throw std::runtime_error("Vertex index out of range: " + std::to_string(idx));
+        }
+    }
+
+    pointCount = static_cast<int>(npoints);
+    vertexCount = static_cast<int>(indices.size());
+    tetCount = static_cast<int>(ntets);
+    surfaceCount = static_cast<int>(ntris);
+    primitiveCount = tetCount + surfaceCount;
+
+    std::string summary;
+    if (ntets > 0) summary += "     " + withThousandsSeparators(ntets) + " Tetrahedrons\n";
+    if (ntris > 0) summary += "     " + withThousandsSeparators(ntris) + " Polygons\n";
+    nlohmann::json newInfo = info.is_object() ? info : nlohmann::json::object();
+    newInfo["primcount_summary"] = summary;
+    newInfo.erase("attribute_summary");
+    newInfo.erase("group_summary");
+    info = newInfo;
+
+    nlohmann::json tuples = nlohmann::json::array();
+    for (size_t i = 0; i < npoints; i++) {
+        tuples.push_back({positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]});
+    }
+    nlohmann::json pAttribute = nlohmann::json::array({
+        nlohmann::json::array({"scope", "public", "type", "numeric", "name", "P",
+                               "options", {{"type", {{"type", "string"}, {"value", "point"}}}}}),
+        nlohmann::json::array({"size", 3, "storage", "fpreal32",
+                               "defaults", nlohmann::json::array({"size", 1, "storage", "fpreal64", "values", nlohmann::json::array({0})}),
+                               "values", nlohmann::json::array({"size", 3, "storage", "fpreal32", "tuples", std::move(tuples)})}),
+    });
+
+    primitives = nlohmann::json::array();
+    if (ntets > 0) {
+        primitives.push_back(nlohmann::json::array({
+            nlohmann::json::array({"type", "Tetrahedron_run"}),
+            nlohmann::json::array({"startvertex", 0, "nprimitives", ntets}),
+        }));
+    }
+    if (ntris > 0) {
+        primitives.push_back(nlohmann::json::array({
+            nlohmann::json::array({"type", "Polygon_run"}),
+            nlohmann::json::array({"startvertex", ntets * 4, "nprimitives", ntris, "nvertices_rle", nlohmann::json::array({3, ntris})}),
+        }));
+    }
+
+    // 原文档中与新拓扑无关的部分原样带过去：全局属性总是保留；P以外的点属性和其它点组
+    // 只在点数不变、点没有被applyReordering()重排过时保留，这时逐点的值仍与点序对应
+    nlohmann::json pointAttributes = nlohmann::json::array({std::move(pAttribute)});
+    nlohmann::json globalAttributes = nlohmann::json::array();
+    nlohmann::json keptPointGroups = nlohmann::json::array();
+    const nlohmann::json* oldPointCount = pairValue(raw, "pointcount");
+    const bool keepPointData = rawPointOrderValid && oldPointCount != nullptr && oldPointCount->is_number_integer() &&
+                               oldPointCount->get<long long>() == static_cast<long long>(npoints);
+    if (const nlohmann::json* oldAttributes = pairValue(raw, "attributes")) {
+        const nlohmann::json* oldPointAttributes = pairValue(*oldAttributes, "pointattributes");
+        if (keepPointData && oldPointAttributes != nullptr && oldPointAttributes->is_array()) {
+            for (const auto& attribute : *oldPointAttributes) {
+                if (!hasName(attribute, "P")) pointAttributes.push_back(attribute);
+            }
+        }
+        if (const nlohmann::json* oldGlobalAttributes = pairValue(*oldAttributes, "globalattributes")) {
+            globalAttributes = *oldGlobalAttributes;
+        }
+    }
+    const nlohmann::json* oldPointGroups = pairValue(raw, "pointgroups");
+    if (keepPointData && oldPointGroups != nullptr && oldPointGroups->is_array()) {
+        for (const auto& group : *oldPointGroups) {
+            if (!hasName(group, "surface_points") && !hasName(group, "interior_points")) keptPointGroups.push_back(group);
+        }
+    }
+
+    pointgroups = nlohmann::json::array();
+    if (!is_surface_point.empty()) {
+        pointgroups.push_back(pointGroup("surface_points", encodeBoolRLE(surface_point_bits, npoints, false)));
+        pointgroups.push_back(pointGroup("interior_points", encodeBoolRLE(surface_point_bits, npoints, true)));
+    }
+    for (auto& group : keptPointGroups) {
+        pointgroups.push_back(std::move(group));
+    }
+
+    nlohmann::json attributeSections = nlohmann::json::array({"pointattributes", std::move(pointAttributes)});
+    if (!globalAttributes.empty()) {
+        attributeSections.push_back("globalattributes");
+        attributeSections.push_back(std::move(globalAttributes));
+    }
+
+    raw = nlohmann::json::array({
+        "fileversion", fileVersion.empty() ? "20.5.550" : fileVersion,
+        "hasindex", false,
+        "pointcount", npoints,
+        "vertexcount", indices.size(),
+        "primitivecount", ntets + ntris,
+        "info", info,
+        "topology", nlohmann::json::array({"pointref", nlohmann::json::array({"indices", indices})}),
+        "attributes", std::move(attributeSections),
+        "primitives", primitives,
+    });
+    if (!pointgroups.empty()) {
+        raw.push_back("pointgroups");
+        raw.push_back(pointgroups);
+    }
+    rawVersion++;
+    rawPointOrderValid = true;
+    tetWriteFingerprint = topologyFingerprint();
+    tetWriteTopologyValid = true;
+
+    write(output);
+}
+
+// 在原始的pair list文档中找到P属性的tuples数组，找不到返回nullptr
+nlohmann::json* HoudiniGeoIO::findPositionTuples(nlohmann::json& doc) {
+    if (!doc.is_array()) {
+        return nullptr;
+    }
+    for (size_t i = 0; i + 1 < doc.size(); i += 2) {
+        if (!isString(doc[i], "attributes")) continue;
+        auto& attribs = doc[i + 1];
+        for (size_t j = 0; j + 1 < attribs.size(); j += 2) {
+            if (!isString(attribs[j], "pointattributes")) continue;
+            for (auto& attr : attribs[j + 1]) {
+                const auto& metadata = attr[0];
+                bool isP = false;
+                for (size_t k = 0; k + 1 < metadata.size(); k += 2) {
+                    if (isString(metadata[k], "name") && isString(metadata[k + 1], "P")) {
+                        isP = true;
+                        break;
+                    }
+                }
+                if (!isP) continue;
+                auto& data = attr[1];
+                for (size_t k = 0; k + 1 < data.size(); k += 2) {
+                    if (isString(data[k], "values")) {
+                        return &data[k + 1][5];
+                    }
+                }
+            }
+        }
+    }
+    return nullptr;
 }
 
 //free functions for easy access and read tetrahedron vertices from indices and positions.
@@ -226,14 +1128,21 @@ std::pair<std::vector<double>, std::vector<int>> EasyReadTetFromHoudini(
 }
 
 void HoudiniGeoIO::readTetWithSurface(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file: " + filePath);
-    }
+    std::ifstream localFile;
+    std::istream& file = openInput(filePath, localFile);
 
     try {
-        // 从文件读取JSON数据
-        raw = nlohmann::json::parse(file);
+        // 从文件读取JSON数据。拓扑与上一帧相同时只解析变化的属性
+        if (loadGeoFile(file, filePath, 1)) {
+            validateAfterRead();
+            std::cout << "Finish reading geo file (topology reused): " << filePath << std::endl;
+            return;
+        }
+        rawVersion++;
+        tetWriteTopologyValid = false;
+        info = nlohmann::json();
+        surfaceCount = 0;
+        tetCount = 0;
         
         // 遍历键值对并设置属性
         for (size_t i = 0; i < raw.size(); i += 2) {
@@ -261,27 +1170,7 @@ void HoudiniGeoIO::readTetWithSurface(const std::string& filePath) {
                 if (info.contains("primcount_summary")) {
                     const auto& summary = info["primcount_summary"];
                     if (summary.is_string()) {
-                        std::string summaryStr = summary.get<std::string>();
-                        std::istringstream ss(summaryStr);
-                        std::string line;
-                        while (std::getline(ss, line)) {
-                            // Remove leading/trailing whitespace
-                            line.erase(0, line.find_first_not_of(" \t\n\r"));
-                            line.erase(line.find_last_not_of(" \t\n\r") + 1);
-                            if (line.empty()) continue;
-                            // Find number and type
-                            std::smatch match;
-                            std::regex re(R"((\d[\d,]*)\s+([A-Za-z]+))");
-                            if (std::regex_search(line, match, re)) {
-                                int count = std::stoi(std::regex_replace(match[1].str(), std::regex(","), ""));
-                                std::string primType = match[2];
-                                if (primType == "Polygons" || primType == "Polygon") {
-                                    surfaceCount = count;
-                                } else if (primType == "Tetrahedrons" || primType == "Tetrahedron" || primType == "Tet") {
-                                    tetCount = count;
-                                }
-                            }
-                        }
+                        parsePrimcountSummary(summary.get<std::string>(), tetCount, surfaceCount);
                     }
                 }
             }
@@ -301,6 +1190,9 @@ void HoudiniGeoIO::readTetWithSurface(const std::string& filePath) {
         std::cout << "Parsing point attributes for TetWithSurface..." << std::endl;
         parsePointAttributes_TetWithSurface();
         // parsePrimAttributes();
+        parsedTopologyHash = fileTopologyHash;
+        parsedTopologyMode = fileTopologyHashValid ? 1 : -1;
+        validateAfterRead();
 
         std::cout << "Finish reading geo file: " << filePath << std::endl;
     }
@@ -316,6 +1208,30 @@ void HoudiniGeoIO::readTetWithSurface(const std::string& filePath) {
 
 
 
+// info.primcount_summary形如 "     20,044 Tetrahedrons\n      1,200 Polygons\n"
+void HoudiniGeoIO::parsePrimcountSummary(const std::string& summary, int& tetCount, int& polygonCount) {
+    std::istringstream ss(summary);
+    std::string line;
+    while (std::getline(ss, line)) {
+        // Remove leading/trailing whitespace
+        line.erase(0, line.find_first_not_of(" \t\n\r"));
+        line.erase(line.find_last_not_of(" \t\n\r") + 1);
+        if (line.empty()) continue;
+        // Find number and type
+        std::smatch match;
+        std::regex re(R"((\d[\d,]*)\s+([A-Za-z]+))");
+        if (std::regex_search(line, match, re)) {
+            int count = std::stoi(std::regex_replace(match[1].str(), std::regex(","), ""));
+            std::string primType = match[2];
+            if (primType == "Polygons" || primType == "Polygon") {
+                polygonCount = count;
+            } else if (primType == "Tetrahedrons" || primType == "Tetrahedron" || primType == "Tet") {
+                tetCount = count;
+            }
+        }
+    }
+}
+
 void HoudiniGeoIO::parseVert_TetWithSurface() {
     // 检查是否存在indices
     if (pointRef.find("indices") == pointRef.end()) {
@@ -531,6 +1447,7 @@ void HoudiniGeoIO::parsePointAttributes_TetWithSurface() {
 
     // 解析 surface_points pointgroup 的 boolRLE，填充 is_surface_point
     is_surface_point.clear();
+    surface_point_bits.clear();
     if (!pointgroups.is_null() && pointgroups.is_array()) {
         nlohmann::json surface_points_group;
         for (const auto& group : pointgroups) {
@@ -544,12 +1461,12 @@ void HoudiniGeoIO::parsePointAttributes_TetWithSurface() {
  
         if (!surface_points_group.is_null()) {
             std::vector<int> boolRLE = surface_points_group[1][1][1].get<std::vector<int>>();
+            size_t count = decodeBoolRLE(boolRLE, surface_point_bits);
             for (size_t i = 0; i < boolRLE.size(); i+=2) {
-                for (int j = 0; j < boolRLE[i]; ++j) {
-                    is_surface_point.push_back(boolRLE[i+1]);
-                }
+                is_surface_point.insert(is_surface_point.end(), boolRLE[i], boolRLE[i+1] != 0);
             }
-            if (is_surface_point.size() != pointCount) {
+            const size_t expected = pointCount < 0 ? 0 : static_cast<size_t>(pointCount);
+            if (count != expected || is_surface_point.size() != expected) {
                 throw std::runtime_error("Decoded surface_points boolRLE size does not match pointCount");
             }
         }
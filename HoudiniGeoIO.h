@@ -3,28 +3,143 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <istream>
+#include <fstream>
+#include <cstdint>
+#include <functional>
 #include <Eigen/Dense>
 #include "json.hpp"
+#include "HoudiniGeoLayout.h"
+#include "HoudiniGeoScan.h"
+#include "HoudiniGeoRestState.h"
+#include "HoudiniGeoTopology.h"
+#include "HoudiniGeoValidate.h"
 
 
+// 输出/输入的文件格式，由扩展名决定
+enum class GeoFileFormat {
+    Ascii,       // .geo
+    Binary,      // .bgeo
+    AsciiGzip,   // .geo.gz，需要zlib
+    BinaryGzip,  // .bgeo.gz，需要zlib
+};
+
+// readInto()的目标内存。回调收到需要的元素个数，返回至少能放下这么多元素的内存
+// （例如调用方预先分配好的对齐或锁页缓冲区）。不需要的数据留空，不会被解析。
+struct GeoReadTargets {
+    std::function<double*(size_t count)> positions;    // 点数*3
+    GeoPositionBuffer* positionBuffer = nullptr;       // 设置时P按它的布局（SoA/AoSoA、对齐、补齐）直接写入
+    std::function<int*(size_t count)> indices;         // 全部顶点对应的点索引，vertexcount个
+    std::function<int*(size_t count)> tetIndices;      // 四面体数*4
+    std::function<int*(size_t count)> surfaceIndices;  // 三角形数*3
+    // 其它数值点属性，按属性名，回调参数为点数和每点的分量数
+    std::map<std::string, std::function<double*(size_t pointCount, int tupleSize)>> pointAttributes;
+};
+
+struct GeoReadSizes {
+    size_t pointCount = 0;
+    size_t vertexCount = 0;
+    size_t tetCount = 0;
+    size_t surfaceCount = 0;
+};
+
 class HoudiniGeoIO {
 public:
     HoudiniGeoIO(const std::string& input = "");
     
     void read(const std::string& filePath);
     void readTetWithSurface(const std::string& filePath);
+    // 直接读入调用方的内存：先扫描出各段的位置和数量，按数量向targets要内存，再把数字直接解析进去，
+    // 不经过DOM和positions等成员（这些成员不会被更新）。二进制/压缩格式先解码再走同样的路径。
+    GeoReadSizes readInto(const std::string& filePath, const GeoReadTargets& targets);
     void write(const std::string& output = "");
+    // 由tet_indices、surface_indices、is_surface_point和positions重新生成Houdini几何并写出：
+    // Tetrahedron_run + Polygon_run，以及surface_points/interior_points两个点组。
+    // 读入文档中的info（图元/属性统计除外）和全局属性原样保留；P以外的点属性和其它点组在点数不变、
+    // 点没有被applyReordering()重排时保留，否则丢弃。图元属性、顶点属性和图元组总是丢弃（图元已重新生成）
+    void writeTetWithSurface(const std::string& output = "");
+
+    static GeoFileFormat formatFromPath(const std::string& filePath);
+    // 读出文件的文本JSON；二进制/压缩格式解码后转成文本，供按字节范围扫描的读取方式使用
+    static std::string loadAsText(const std::string& filePath);
+    // 解析info.primcount_summary中的四面体数和多边形数（没有出现的保持不变）
+    static void parsePrimcountSummary(const std::string& summary, int& tetCount, int& polygonCount);
+
+    // 拓扑指纹：indices、tet_indices、surface_indices、表面点标记和点数的哈希。
+    // write()会把topology/primitives/点组/图元组各段序列化一次并按指纹缓存，
+    // 拓扑不变的序列逐帧导出时只序列化变化的属性。
+    uint64_t topologyFingerprint() const;
     
     // Setters
-    void setPositions(const std::vector<double>& pos);
+    void setPositions(const std::vector<double>& pos); // 点数需与读入时一致，同时更新待写出的P
+    void setTetIndices(const std::vector<int>& tets) { tet_indices = tets; parsedTopologyMode = -1; }
+    void setSurfaceIndices(const std::vector<int>& tris) { surface_indices = tris; parsedTopologyMode = -1; }
+    void setIsSurfacePoint(const std::vector<bool>& flags);
+    // 由tet_indices提取边界三角形替换surface_indices，并按边界三角形的顶点精确重建is_surface_point。
+    // 用于只有四面体、没有Polygon_run的文件（只带surface_points点组）
+    void extractSurface();
+    // 四面体的面邻接和点->四面体关联（CSR）。第一次调用时构建，按tet_indices和点数的哈希缓存，
+    // 四面体变化（重新读入、setTetIndices()等）后下一次调用时重建
+    const GeoTetAdjacency& getTetAdjacency();
+    // tet_indices对应的3x3分块刚度矩阵稀疏结构和单元散射表
+    void getBlockSparsity(GeoBlockSparsity& out) const { HoudiniGeoBuildBlockSparsity(tet_indices, positions.size() / 3, out); }
+    // 按公共点给四面体着色，同一颜色的四面体可以并行求解
+    void colorTets(GeoColoring& out) const { HoudiniGeoColorElements(tet_indices, 4, positions.size() / 3, out); }
+    // 检查索引范围、四面体朝向和形状质量、没有用到的点，以及surface_points点组是否与实际边界一致
+    GeoMeshReport validate() const { return HoudiniGeoValidateMesh(tet_indices, surface_indices, positions, is_surface_point); }
+    // 开启后每次readTetWithSurface()读完都执行validate()，结果由getLastReport()取得，有问题时输出到std::cerr
+    void setValidateOnRead(bool enable) { validateOnRead = enable; }
+    const GeoMeshReport& getLastReport() const { return lastReport; }
+    // 当前位置作为静止状态：体积、Dm^-1和集中质量（density为单位体积质量），借用getTetAdjacency()按点并行累加质量
+    void computeRestState(GeoRestState& out, double density);
+    // 按空间填充曲线重排点、四面体和三角形，提高求解器收集/散射时的缓存命中率。
+    // 返回的重排可交给applyReordering(r.inverse())恢复原顺序，或用HoudiniGeoPermute把求解结果换回原顺序
+    GeoReordering reorderSpatially(GeoSpaceFillingCurve curve = GeoSpaceFillingCurve::Hilbert);
+    // 按Reverse Cuthill-McKee重排点，降低隐式求解中刚度矩阵的带宽，应用和恢复方式与reorderSpatially()相同。
+    // bandwidth不为空时写入重排前后的带宽
+    GeoReordering reorderBandwidth(GeoBandwidth* bandwidth = nullptr);
+    // 按连通分量标记点和图元（tet_indices和surface_indices）
+    void labelComponents(GeoComponents& out) const {
+        HoudiniGeoLabelComponents(tet_indices, surface_indices, positions.size() / 3, out);
+    }
+    // 标记连通分量并重排，使每个分量的点、四面体和三角形各自连续（分量内保持原顺序），
+    // 第c个分量为components中的第c段区间，分量编号也换成新顺序。恢复方式与reorderSpatially()相同
+    GeoReordering reorderByComponent(GeoComponents& components);
+    // 按重排更新positions、tet_indices、surface_indices、indices中的点编号和is_surface_point（点组）。
+    // raw中的原始文档不随之改变，重排后用writeTetWithSurface()写出
+    void applyReordering(const GeoReordering& reordering);
+    // tet_indices和surface_indices中不重复的边（每2个一条）及其在positions中的长度，用于弹簧/应变限制约束
+    void getEdges(std::vector<int>& edges, std::vector<double>& restLengths) const {
+        HoudiniGeoExtractEdges(tet_indices, surface_indices, positions, edges, &restLengths);
+    }
+
+    // 顺序读取拓扑不变的序列时，read()/readTetWithSurface()会复用已解析的拓扑，只解析P等点属性。
+    // 返回上一次读取是否走了这条路径。
+    bool lastReadReusedTopology() const { return reusedTopology; }
+
+    // 复用模式：同一个对象反复读入时保留全部缓冲区的容量（文件流及其缓冲、文件内容、位置数组、
+    // 解析出的JSON结构），拓扑复用时info和attributes按原有结构就地更新而不是重新解析。
+    // 文本.geo拓扑不变的序列稳态逐帧读取时不再有堆分配。结构变化（例如新增属性）时自动退回完整解析。
+    void setReuseBuffers(bool enable) { reuseBuffers = enable; }
+    bool getReuseBuffers() const { return reuseBuffers; }
     
     // Getters
     std::vector<double> getPositions() const { return positions; }
+    void getPositions(GeoPositionBuffer& out) const { out.assign(positions.data(), positions.size() / 3); }
     std::vector<std::vector<int>> getVert() const { return vert; }
     std::vector<int> getIndices() const { return indices; }
     std::vector<int> getSurfaceIndicies() const { return surface_indices; }
     std::vector<int> getTetIndicies() const { return tet_indices; }
     std::vector<bool> getIsSurfacePoint() const { return is_surface_point; }
+    double getTime() const; // info.time，没有时返回0
+    bool getBounds(double bounds[6]) const; // info.bounds：xmin,xmax,ymin,ymax,zmin,zmax，没有时返回false
+
+    // 不拷贝的只读访问，下一次read()后失效
+    const std::vector<double>& getPositionsRef() const { return positions; }
+    const std::vector<int>& getIndicesRef() const { return indices; }
+    const std::vector<int>& getTetIndicesRef() const { return tet_indices; }
+    const std::vector<int>& getSurfaceIndicesRef() const { return surface_indices; }
+    const std::vector<bool>& getIsSurfacePointRef() const { return is_surface_point; }
     
 private:
     void parseVert();
@@ -36,6 +151,16 @@ private:
     void parsePrimAttributes_TetWithSurface();
     
     static std::map<std::string, nlohmann::json> pairListToDict(const nlohmann::json& pairs);
+    std::istream& openInput(const std::string& filePath, std::ifstream& local);
+    void readFileBuffer(std::istream& file);
+    bool loadGeoFile(std::istream& file, const std::string& filePath, int mode);
+    void parseVaryingSections(int mode);
+    bool updateVaryingSectionsInPlace();
+    static nlohmann::json parseGeoFile(std::istream& file, const std::string& filePath);
+    static nlohmann::json* findPositionTuples(nlohmann::json& doc);
+    std::string serialize(bool binary);
+    static size_t decodeBoolRLE(const std::vector<int>& rle, std::vector<uint64_t>& bits);
+    static nlohmann::json encodeBoolRLE(const std::vector<uint64_t>& bits, size_t count, bool invert);
     
     std::string inputPath;
     nlohmann::json raw;          // 原始JSON数据
@@ -49,13 +174,13 @@ private:
     
     // File attributes
     std::string fileVersion;
-    bool hasIndex;
-    int pointCount;
-    int vertexCount;
-    int primitiveCount; // Primitive count, e.g., number of all tetrahedra or triangles
-    int surfaceCount; // Number of surface primitives, e.g., triangles
-    int tetCount; // Number of tetrahedral primitives, e.g., tets
-    size_t NVERT_ONE_PRIM;// Number of vertices per primitive, e.g., 3 for triangles, 4 for tet, etc.
+    bool hasIndex = false;
+    int pointCount = 0;
+    int vertexCount = 0;
+    int primitiveCount = 0; // Primitive count, e.g., number of all tetrahedra or triangles
+    int surfaceCount = 0; // Number of surface primitives, e.g., triangles
+    int tetCount = 0; // Number of tetrahedral primitives, e.g., tets
+    size_t NVERT_ONE_PRIM = 0;// Number of vertices per primitive, e.g., 3 for triangles, 4 for tet, etc.
     std::string primType; // Primitive type, e.g., "tet", "tri", etc.
 
     // Geometry data
@@ -66,11 +191,60 @@ private:
     std::vector<int> tet_indices;
     std::vector<int> surface_indices; // Surface indices for triangles, if applicable
     std::vector<bool> is_surface_point; // Whether a point is a surface point
+    std::vector<uint64_t> surface_point_bits; // is_surface_point按64位字打包，用于按字做RLE编解码
+
+    // 已序列化的拓扑段，键为(指纹, raw版本, 编码)
+    struct SerializedTopology {
+        bool valid = false;
+        bool binary = false;
+        uint64_t fingerprint = 0;
+        uint64_t rawVersion = 0;
+        std::map<std::string, std::string> sections;
+    };
+    SerializedTopology topologyCache;
+    uint64_t rawVersion = 0; // raw被整体替换（读文件、拓扑变化后重建）时递增
+    bool tetWriteTopologyValid = false; // writeTetWithSurface上次生成的拓扑段是否可复用
+    bool rawPointOrderValid = true;     // raw中逐点的属性和点组与当前点序一致（applyReordering()重排点后为false）
+    uint64_t tetWriteFingerprint = 0;
+
+    // getTetAdjacency()的缓存
+    GeoTetAdjacency tetAdjacency;
+    uint64_t tetAdjacencyKey = 0;
+    bool tetAdjacencyValid = false;
+
+    // setValidateOnRead()
+    bool validateOnRead = false;
+    GeoMeshReport lastReport;
+    void validateAfterRead();
+
+    // 逐帧读取时的拓扑复用：文本文件整体读入fileBuffer，扫描出顶层各段的字节范围，
+    // 对点数/图元数、topology、primitives和各组的字节做哈希。与上一帧相同时只解析info和attributes。
+    std::string fileBuffer;
+    std::vector<HoudiniGeoScan::Section> fileSections;
+    uint64_t fileTopologyHash = 0;     // 本次读入文件的拓扑段哈希
+    bool fileTopologyHashValid = false;
+    uint64_t parsedTopologyHash = 0;   // 当前indices等数据对应的拓扑段哈希
+    int parsedTopologyMode = -1;       // 0: read()，1: readTetWithSurface()，-1: 不可复用
+    bool reusedTopology = false;
+
+    // 复用模式
+    bool reuseBuffers = false;
+    struct ReusedInput {  // 拷贝对象时不共享文件流，副本第一次读入时重新建立
+        std::ifstream stream;
+        std::vector<char> buffer;
+        ReusedInput() = default;
+        ReusedInput(const ReusedInput&) {}
+        ReusedInput& operator=(const ReusedInput&) { return *this; }
+    };
+    ReusedInput reusedInput;
+    std::string keyScratch;
 };
 
 
 
 //free functions for easy access and read tetrahedron vertices from indices and positions.
+uint64_t HoudiniGeoHash(const void* data, size_t size, uint64_t seed = 0);
+
 std::pair<std::vector<double>, std::vector<int>> EasyReadTetFromHoudini(
     const std::string& filePath
 );
@@ -0,0 +1,95 @@
+#include "HoudiniGeoLayout.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+
+namespace {
+
+size_t roundUp(size_t n, size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+}
+
+void GeoPositionBuffer::AlignedDelete::operator()(double* p) const {
+    ::operator delete(p, std::align_val_t(alignment));
+}
+
+GeoPositionBuffer::GeoPositionBuffer(Options options)
+    : options(options), memory(nullptr, AlignedDelete{options.alignment}) {
+    if (options.alignment < sizeof(double) || (options.alignment & (options.alignment - 1)) != 0) {
+        throw std::runtime_error("Position buffer alignment must be a power of two >= 8");
+    }
+    if (this->options.padMultiple == 0) {
+        this->options.padMultiple = 1;
+    }
+}
+
+void GeoPositionBuffer::resize(size_t pointCount) {
+    size_t multiple = options.padMultiple;
+    if (options.layout == GeoPositionLayout::AoSoA8) multiple = roundUp(multiple, 8);
+    if (options.layout == GeoPositionLayout::AoSoA16) multiple = roundUp(multiple, 16);
+
+    count = pointCount;
+    padded = roundUp(pointCount, multiple);
+    size_t total = padded * 3;
+    if (options.layout == GeoPositionLayout::SoA) {
+        // 每个分量数组的起点都要对齐
+        stride = roundUp(padded, options.alignment / sizeof(double));
+        total = stride * 3;
+    }
+    else {
+        stride = padded;
+    }
+
+    if (total > capacity || !memory) {
+        void* p = ::operator new(std::max<size_t>(total, 1) * sizeof(double), std::align_val_t(options.alignment));
+        memory.reset(static_cast<double*>(p));
+        capacity = total;
+    }
+}
+
+void GeoPositionBuffer::assign(const double* xyz, size_t pointCount) {
+    resize(pointCount);
+    double* out = memory.get();
+    switch (options.layout) {
+    case GeoPositionLayout::AoS:
+        std::copy(xyz, xyz + pointCount * 3, out);
+        break;
+    case GeoPositionLayout::SoA:
+        for (size_t i = 0; i < pointCount; i++) {
+            out[i] = xyz[i * 3 + 0];
+            out[stride + i] = xyz[i * 3 + 1];
+            out[2 * stride + i] = xyz[i * 3 + 2];
+        }
+        break;
+    default:
+        for (size_t i = 0; i < pointCount; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                out[offset(i, axis)] = xyz[i * 3 + axis];
+            }
+        }
+        break;
+    }
+    fillPadding();
+}
+
+void GeoPositionBuffer::fillPadding() {
+    double* out = memory.get();
+    for (size_t i = count; i < padded; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            out[offset(i, axis)] = count > 0 ? out[offset(count - 1, axis)] : 0.0;
+        }
+    }
+}
+
+void GeoPositionBuffer::toInterleaved(std::vector<double>& xyz) const {
+    xyz.resize(count * 3);
+    const double* in = memory.get();
+    for (size_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            xyz[i * 3 + axis] = in[offset(i, axis)];
+        }
+    }
+}
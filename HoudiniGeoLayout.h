@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+// 位置数组的内存布局
+enum class GeoPositionLayout {
+    AoS,     // x0 y0 z0 x1 y1 z1 ...（与HoudiniGeoIO::positions相同）
+    SoA,     // x0 x1 ... | y0 y1 ... | z0 z1 ...，三个数组分别对齐
+    AoSoA8,  // 每8个点一块：x0..x7 y0..y7 z0..z7，AVX-512一次处理一个分量
+    AoSoA16, // 每16个点一块
+};
+
+struct GeoPositionLayoutOptions {
+    GeoPositionLayout layout = GeoPositionLayout::AoS;
+    size_t alignment = 64;   // 字节，需为2的幂且不小于sizeof(double)
+    size_t padMultiple = 1;  // 点数补齐到它的整数倍（例如8），SIMD循环不需要处理余数
+};
+
+// 按布局存放的位置数组，内存按alignment对齐。
+// 补齐出来的点复制最后一个真实点的坐标，包围盒/碰撞类的核函数直接遍历paddedSize()个点也不会出错。
+class GeoPositionBuffer {
+public:
+    using Options = GeoPositionLayoutOptions;
+
+    explicit GeoPositionBuffer(Options options = Options());
+
+    // 重新分配为pointCount个点（容量足够时不重新分配），内容未定义
+    void resize(size_t pointCount);
+
+    // 由交错的xyz填充，并填好补齐的点
+    void assign(const double* xyz, size_t pointCount);
+    // 已写好前size()个点后调用，把最后一个点复制到补齐位置
+    void fillPadding();
+
+    size_t size() const { return count; }
+    size_t paddedSize() const { return padded; }
+    GeoPositionLayout layout() const { return options.layout; }
+
+    // 第point个点的axis分量在data()中的下标
+    size_t offset(size_t point, int axis) const {
+        switch (options.layout) {
+        case GeoPositionLayout::SoA: return axis * stride + point;
+        case GeoPositionLayout::AoSoA8: return (point / 8) * 24 + axis * 8 + point % 8;
+        case GeoPositionLayout::AoSoA16: return (point / 16) * 48 + axis * 16 + point % 16;
+        default: return point * 3 + axis;
+        }
+    }
+
+    double* data() { return memory.get(); }
+    const double* data() const { return memory.get(); }
+
+    // SoA时三个分量数组的起点（各自对齐）
+    double* x() { return memory.get(); }
+    double* y() { return memory.get() + stride; }
+    double* z() { return memory.get() + 2 * stride; }
+    const double* x() const { return memory.get(); }
+    const double* y() const { return memory.get() + stride; }
+    const double* z() const { return memory.get() + 2 * stride; }
+
+    void toInterleaved(std::vector<double>& xyz) const;
+
+private:
+    struct AlignedDelete {
+        size_t alignment;
+        void operator()(double* p) const;
+    };
+
+    Options options;
+    size_t count = 0;
+    size_t padded = 0;
+    size_t stride = 0;    // SoA时每个分量数组占的double数
+    size_t capacity = 0;  // 已分配的double数
+    std::unique_ptr<double[], AlignedDelete> memory;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// 简单的线程池，供压缩、预读、拓扑计算等并行阶段共用。
+class HoudiniGeoThreadPool {
+public:
+    explicit HoudiniGeoThreadPool(unsigned numThreads = 0) {
+        if (numThreads == 0) {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < numThreads; i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~HoudiniGeoThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+    HoudiniGeoThreadPool(const HoudiniGeoThreadPool&) = delete;
+    HoudiniGeoThreadPool& operator=(const HoudiniGeoThreadPool&) = delete;
+
+    template <class F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([task] { (*task)(); });
+        }
+        cv.notify_one();
+        return result;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // 进程内共享的默认线程池
+    static HoudiniGeoThreadPool& global() {
+        static HoudiniGeoThreadPool pool;
+        return pool;
+    }
+
+private:
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+
+// 把[begin, end)按grain切块，fn(chunkBegin, chunkEnd)在线程池和调用线程上并行执行。
+// 调用线程自己也会领取块，所以在线程池任务里嵌套调用也不会死锁。
+template <class F>
+void HoudiniGeoParallelFor(size_t begin, size_t end, size_t grain, F&& fn) {
+    if (end <= begin) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t numChunks = (end - begin + grain - 1) / grain;
+    HoudiniGeoThreadPool& pool = HoudiniGeoThreadPool::global();
+    if (numChunks == 1 || pool.size() <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    auto fnPtr = &fn;
+
+    // 领取并执行块，直到全部领完。fnPtr只在done计数未满时被访问。
+    auto work = [state, fnPtr, begin, end, grain, numChunks] {
+        for (;;) {
+            size_t c = state->next.fetch_add(1);
+            if (c >= numChunks) {
+                return;
+            }
+            size_t b = begin + c * grain;
+            size_t e = std::min(end, b + grain);
+            try {
+                (*fnPtr)(b, e);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) state->error = std::current_exception();
+            }
+            if (state->done.fetch_add(1) + 1 == numChunks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min<size_t>(pool.size(), numChunks - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        pool.submit(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == numChunks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
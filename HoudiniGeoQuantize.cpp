@@ -0,0 +1,307 @@
+#include "HoudiniGeoQuantize.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HOUDINIGEO_HAS_SSE2
+#endif
+
+
+namespace {
+
+const size_t BLOCK_SIZE = 256;  // 每块的分量数
+
+// 把bits位的差分（模2^bits）还原成有符号数
+inline int32_t signExtend(uint32_t v, int bits) {
+    const int shift = 32 - bits;
+    return static_cast<int32_t>(v << shift) >> shift;
+}
+
+inline uint8_t widthCode(int32_t maxAbs) {
+    if (maxAbs == 0) return 0;
+    if (maxAbs <= 127) return 1;
+    if (maxAbs <= 32767) return 2;
+    return 3;
+}
+
+}
+
+HoudiniGeoQuantizedStore::HoudiniGeoQuantizedStore(const double bounds[6], Options options)
+    : options(options) {
+    if (options.bits < 1 || options.bits > 24) {
+        throw std::runtime_error("Quantization bits must be in [1, 24]");
+    }
+    if (this->options.keyframeInterval < 1) {
+        this->options.keyframeInterval = 1;
+    }
+    mask = (uint32_t(1) << options.bits) - 1;
+    for (int axis = 0; axis < 3; axis++) {
+        double lo = bounds[2 * axis];
+        double hi = bounds[2 * axis + 1];
+        if (hi < lo) std::swap(lo, hi);
+        boundsMin[axis] = lo;
+        step[axis] = (hi - lo) / mask;
+    }
+}
+
+void HoudiniGeoQuantizedStore::boundsFromGeo(const HoudiniGeoIO& geo, double bounds[6], double padding) {
+    if (!geo.getBounds(bounds)) {
+        const auto& pos = geo.getPositionsRef();
+        for (int axis = 0; axis < 3; axis++) {
+            bounds[2 * axis] = std::numeric_limits<double>::max();
+            bounds[2 * axis + 1] = std::numeric_limits<double>::lowest();
+        }
+        for (size_t i = 0; i + 2 < pos.size(); i += 3) {
+            for (int axis = 0; axis < 3; axis++) {
+                bounds[2 * axis] = std::min(bounds[2 * axis], pos[i + axis]);
+                bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], pos[i + axis]);
+            }
+        }
+        if (pos.empty()) {
+            std::fill(bounds, bounds + 6, 0.0);
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        double pad = (bounds[2 * axis + 1] - bounds[2 * axis]) * padding;
+        bounds[2 * axis] -= pad;
+        bounds[2 * axis + 1] += pad;
+    }
+}
+
+void HoudiniGeoQuantizedStore::quantize(const double* positions, uint32_t* q) {
+    for (size_t i = 0; i < numValues; i++) {
+        const int axis = static_cast<int>(i % 3);
+        double v = 0.0;
+        if (step[axis] > 0.0) {
+            v = std::floor((positions[i] - boundsMin[axis]) / step[axis] + 0.5);
+        }
+        // 求解器发散时会出现NaN，与比较无关，单独记为0，避免转换成整数时未定义
+        if (std::isnan(v) || std::isnan(positions[i])) {
+            clampedValues++;
+            v = 0.0;
+        }
+        else if (v < 0.0 || v > mask) {
+            clampedValues++;
+            v = std::min<double>(std::max(v, 0.0), mask);
+        }
+        q[i] = static_cast<uint32_t>(v);
+
+        // NaN/inf没有有意义的误差，不计入统计
+        if (std::isfinite(positions[i])) {
+            const double err = std::abs(boundsMin[axis] + q[i] * step[axis] - positions[i]);
+            maxAbsError = std::max(maxAbsError, err);
+            sumSquaredError += err * err;
+            errorSamples++;
+        }
+    }
+}
+
+// xyz交错存放，三个轴的步长以6个分量（3对double）为周期
+void HoudiniGeoQuantizedStore::dequantize(const uint32_t* q, double* positions) const {
+    size_t i = 0;
+#ifdef HOUDINIGEO_HAS_SSE2
+    const __m128d offset[3] = {_mm_setr_pd(boundsMin[0], boundsMin[1]),
+                               _mm_setr_pd(boundsMin[2], boundsMin[0]),
+                               _mm_setr_pd(boundsMin[1], boundsMin[2])};
+    const __m128d scale[3] = {_mm_setr_pd(step[0], step[1]),
+                              _mm_setr_pd(step[2], step[0]),
+                              _mm_setr_pd(step[1], step[2])};
+    for (; i + 6 <= numValues; i += 6) {
+        // 量化值不超过24位，按有符号int32转换不会溢出
+        __m128i q0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+        __m128i q1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + i + 4));
+        __m128d v0 = _mm_cvtepi32_pd(q0);
+        __m128d v1 = _mm_cvtepi32_pd(_mm_srli_si128(q0, 8));
+        __m128d v2 = _mm_cvtepi32_pd(q1);
+        _mm_storeu_pd(positions + i, _mm_add_pd(offset[0], _mm_mul_pd(v0, scale[0])));
+        _mm_storeu_pd(positions + i + 2, _mm_add_pd(offset[1], _mm_mul_pd(v1, scale[1])));
+        _mm_storeu_pd(positions + i + 4, _mm_add_pd(offset[2], _mm_mul_pd(v2, scale[2])));
+    }
+#endif
+    for (; i < numValues; i++) {
+        const int axis = static_cast<int>(i % 3);
+        positions[i] = boundsMin[axis] + q[i] * step[axis];
+    }
+}
+
+size_t HoudiniGeoQuantizedStore::append(const std::vector<double>& positions) {
+    if (frames.empty()) {
+        numValues = positions.size();
+        lastEncoded.assign(numValues, 0);
+    }
+    else if (positions.size() != numValues) {
+        throw std::runtime_error("Point count mismatch: store has " + std::to_string(numValues / 3) +
+                                 " points, frame has " + std::to_string(positions.size() / 3));
+    }
+
+    std::vector<uint32_t> q(numValues);
+    quantize(positions.data(), q.data());
+
+    // 关键帧相对全0编码，其余帧相对上一帧
+    const bool keyframe = frames.size() % options.keyframeInterval == 0;
+    if (keyframe) {
+        std::fill(lastEncoded.begin(), lastEncoded.end(), 0);
+    }
+
+    EncodedFrame frame;
+    const size_t numBlocks = (numValues + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    frame.widths.resize(numBlocks);
+    std::vector<int32_t> deltas(BLOCK_SIZE);
+    for (size_t block = 0; block < numBlocks; block++) {
+        const size_t begin = block * BLOCK_SIZE;
+        const size_t count = std::min(BLOCK_SIZE, numValues - begin);
+        int32_t maxAbs = 0;
+        for (size_t j = 0; j < count; j++) {
+            deltas[j] = signExtend((q[begin + j] - lastEncoded[begin + j]) & mask, options.bits);
+            maxAbs = std::max(maxAbs, std::abs(deltas[j]));
+        }
+        const uint8_t code = widthCode(maxAbs);
+        frame.widths[block] = code;
+        const size_t offset = frame.data.size();
+        switch (code) {
+        case 1:
+            frame.data.resize(offset + count);
+            for (size_t j = 0; j < count; j++) {
+                frame.data[offset + j] = static_cast<uint8_t>(static_cast<int8_t>(deltas[j]));
+            }
+            break;
+        case 2:
+            frame.data.resize(offset + count * 2);
+            for (size_t j = 0; j < count; j++) {
+                int16_t d = static_cast<int16_t>(deltas[j]);
+                std::memcpy(&frame.data[offset + j * 2], &d, 2);
+            }
+            break;
+        case 3:
+            frame.data.resize(offset + count * 4);
+            std::memcpy(&frame.data[offset], deltas.data(), count * 4);
+            break;
+        default:
+            break;
+        }
+    }
+    frame.data.shrink_to_fit();
+    frames.push_back(std::move(frame));
+    lastEncoded.swap(q);
+    return frames.size() - 1;
+}
+
+void HoudiniGeoQuantizedStore::applyDeltas(const EncodedFrame& frame, uint32_t mask, uint32_t* q, size_t n) {
+    const uint8_t* data = frame.data.data();
+    for (size_t block = 0; block < frame.widths.size(); block++) {
+        uint32_t* dst = q + block * BLOCK_SIZE;
+        const size_t count = std::min(BLOCK_SIZE, n - block * BLOCK_SIZE);
+        const uint8_t code = frame.widths[block];
+        size_t j = 0;
+#ifdef HOUDINIGEO_HAS_SSE2
+        const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+        if (code == 1) {
+            for (; j + 16 <= count; j += 16) {
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+                // int8 -> int16 -> int32 符号扩展
+                __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);
+                __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8);
+                __m128i d[4] = {_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16),
+                                _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16),
+                                _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16),
+                                _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)};
+                for (int k = 0; k < 4; k++) {
+                    __m128i* p = reinterpret_cast<__m128i*>(dst + j + 4 * k);
+                    _mm_storeu_si128(p, _mm_and_si128(_mm_add_epi32(_mm_loadu_si128(p), d[k]), vmask));
+                }
+            }
+        }
+        else if (code == 2) {
+            for (; j + 8 <= count; j += 8) {
+                __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j * 2));
+                __m128i d[2] = {_mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16),
+                                _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16)};
+                for (int k = 0; k < 2; k++) {
+                    __m128i* p = reinterpret_cast<__m128i*>(dst + j + 4 * k);
+                    _mm_storeu_si128(p, _mm_and_si128(_mm_add_epi32(_mm_loadu_si128(p), d[k]), vmask));
+                }
+            }
+        }
+        else if (code == 3) {
+            for (; j + 4 <= count; j += 4) {
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j * 4));
+                __m128i* p = reinterpret_cast<__m128i*>(dst + j);
+                _mm_storeu_si128(p, _mm_and_si128(_mm_add_epi32(_mm_loadu_si128(p), d), vmask));
+            }
+        }
+#endif
+        switch (code) {
+        case 1:
+            for (; j < count; j++) dst[j] = (dst[j] + static_cast<int8_t>(data[j])) & mask;
+            data += count;
+            break;
+        case 2:
+            for (; j < count; j++) {
+                int16_t d;
+                std::memcpy(&d, data + j * 2, 2);
+                dst[j] = (dst[j] + d) & mask;
+            }
+            data += count * 2;
+            break;
+        case 3:
+            for (; j < count; j++) {
+                int32_t d;
+                std::memcpy(&d, data + j * 4, 4);
+                dst[j] = (dst[j] + d) & mask;
+            }
+            data += count * 4;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void HoudiniGeoQuantizedStore::decode(size_t frame, std::vector<double>& positions) const {
+    if (frame >= frames.size()) {
+        throw std::runtime_error("Frame " + std::to_string(frame) + " is out of range");
+    }
+    const size_t keyframe = frame - frame % options.keyframeInterval;
+    // 游标在同一关键帧区间内且不在目标之后时可以接着累加
+    size_t from;
+    if (cursorFrame != SIZE_MAX && cursorFrame >= keyframe && cursorFrame <= frame) {
+        from = cursorFrame + 1;
+    }
+    else {
+        cursor.assign(numValues, 0);
+        from = keyframe;
+    }
+    for (size_t f = from; f <= frame; f++) {
+        applyDeltas(frames[f], mask, cursor.data(), numValues);
+    }
+    cursorFrame = frame;
+
+    positions.resize(numValues);
+    dequantize(cursor.data(), positions.data());
+}
+
+size_t HoudiniGeoQuantizedStore::bytes() const {
+    size_t total = sizeof(*this) + lastEncoded.capacity() * sizeof(uint32_t);
+    for (const auto& f : frames) {
+        total += sizeof(EncodedFrame) + f.widths.capacity() + f.data.capacity();
+    }
+    return total;
+}
+
+size_t HoudiniGeoQuantizedStore::rawBytes() const {
+    return frames.size() * numValues * sizeof(double);
+}
+
+GeoQuantizationError HoudiniGeoQuantizedStore::error() const {
+    GeoQuantizationError e;
+    e.maxAbs = maxAbsError;
+    e.rms = errorSamples ? std::sqrt(sumSquaredError / errorSamples) : 0.0;
+    e.clamped = clampedValues;
+    for (int axis = 0; axis < 3; axis++) {
+        e.step[axis] = step[axis];
+    }
+    return e;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "HoudiniGeoIO.h"
+
+
+// 量化误差统计（世界空间单位）
+struct GeoQuantizationError {
+    double maxAbs = 0.0;     // 最大单分量误差
+    double rms = 0.0;        // 均方根误差
+    size_t clamped = 0;      // 落在包围盒外被截断，或为NaN（记为包围盒下界）的分量数；NaN/inf不计入maxAbs和rms
+    double step[3] = {0.0, 0.0, 0.0};  // 各轴的量化步长，误差理论上不超过step/2
+};
+
+struct GeoQuantizedStoreOptions {
+    int bits = 16;              // 每个分量的定点位数，1~24，常用16或21
+    int keyframeInterval = 16;  // 每隔多少帧存一个关键帧，解码任意一帧最多累加这么多帧的差分
+};
+
+// 长序列位置的内存压缩存储。
+// 位置按包围盒量化成bits位定点数，每帧只存与上一帧量化值的差分（按模2^bits），
+// 差分按256个分量一块选0/8/16/32位宽存放，静止或慢速运动的点几乎不占空间。
+// 编码时以上一帧的量化值为基准，多帧累加不会漂移。
+class HoudiniGeoQuantizedStore {
+public:
+    using Options = GeoQuantizedStoreOptions;
+
+    // bounds：xmin,xmax,ymin,ymax,zmin,zmax，需覆盖整个序列，超出部分会被截断并计入误差
+    HoudiniGeoQuantizedStore(const double bounds[6], Options options = Options());
+
+    // 取info.bounds，没有时由当前位置计算；padding按包围盒尺寸的比例向外扩
+    static void boundsFromGeo(const HoudiniGeoIO& geo, double bounds[6], double padding = 0.0);
+
+    // 追加一帧，返回帧序号。点数必须与第一帧一致。
+    size_t append(const std::vector<double>& positions);
+
+    // 解码第frame帧。顺序访问时从上一次解码的帧继续累加，不是线程安全的。
+    void decode(size_t frame, std::vector<double>& positions) const;
+
+    size_t frameCount() const { return frames.size(); }
+    size_t pointCount() const { return numValues / 3; }
+    size_t bytes() const;     // 压缩后占用
+    size_t rawBytes() const;  // 同样帧数用double存放的大小
+
+    // 目前为止所有追加帧的量化误差
+    GeoQuantizationError error() const;
+
+private:
+    struct EncodedFrame {
+        std::vector<uint8_t> widths;  // 每块的位宽编码：0/1/2/3 对应 0/8/16/32 位
+        std::vector<uint8_t> data;
+    };
+
+    void quantize(const double* positions, uint32_t* q);
+    void dequantize(const uint32_t* q, double* positions) const;
+    static void applyDeltas(const EncodedFrame& frame, uint32_t mask, uint32_t* q, size_t n);
+
+    Options options;
+    uint32_t mask;
+    double boundsMin[3];
+    double step[3];
+
+    size_t numValues = 0;
+    std::vector<EncodedFrame> frames;
+    std::vector<uint32_t> lastEncoded;  // 上一帧的量化值
+
+    // 误差统计
+    double maxAbsError = 0.0;
+    double sumSquaredError = 0.0;
+    size_t errorSamples = 0;
+    size_t clampedValues = 0;
+
+    // 解码游标
+    mutable std::vector<uint32_t> cursor;
+    mutable size_t cursorFrame = SIZE_MAX;
+};
@@ -0,0 +1,168 @@
+#include "HoudiniGeoRestState.h"
+#include "HoudiniGeoParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HOUDINIGEO_HAS_SSE2
+#endif
+
+
+namespace {
+
+const size_t grainSize = 4096;
+
+// Houdini的四面体从外面看各面为顺时针（与HoudiniGeoExtractBoundary一致），对应det(Dm) < 0
+const double houdiniOrientation = -1.0;
+
+GeoTetState classify(double det, bool valid) {
+    if (!valid) return GeoTetState::Degenerate;
+    return det * houdiniOrientation < 0.0 ? GeoTetState::Inverted : GeoTetState::Valid;
+}
+
+// 单个四面体，SSE2循环的尾部和没有SSE2时使用
+void restTet(const double* p0, const double* p1, const double* p2, const double* p3, size_t t, GeoRestState& out) {
+    double c[3][3];
+    for (int k = 0; k < 3; k++) {
+        c[0][k] = p1[k] - p0[k];
+        c[1][k] = p2[k] - p0[k];
+        c[2][k] = p3[k] - p0[k];
+    }
+    // Dm^-1的第r行为(c[r+1] x c[r+2]) / det
+    double rows[3][3];
+    for (int r = 0; r < 3; r++) {
+        const double* u = c[(r + 1) % 3];
+        const double* w = c[(r + 2) % 3];
+        rows[r][0] = u[1] * w[2] - u[2] * w[1];
+        rows[r][1] = u[2] * w[0] - u[0] * w[2];
+        rows[r][2] = u[0] * w[1] - u[1] * w[0];
+    }
+    const double det = c[0][0] * rows[0][0] + c[0][1] * rows[0][1] + c[0][2] * rows[0][2];
+    double lengthSq = 0.0;
+    for (int e = 0; e < 3; e++) {
+        lengthSq = std::max(lengthSq, c[e][0] * c[e][0] + c[e][1] * c[e][1] + c[e][2] * c[e][2]);
+    }
+    // 写成取反的形式，使NaN坐标也记为退化
+    const bool valid = std::fabs(det) > GeoDegenerateTetTolerance * lengthSq * std::sqrt(lengthSq);
+    const double invDet = valid ? 1.0 / det : 0.0;
+    for (int r = 0; r < 3; r++) {
+        for (int k = 0; k < 3; k++) {
+            out.DmInv[3 * r + k][t] = valid ? rows[r][k] * invDet : 0.0;
+        }
+    }
+    out.volume[t] = valid ? std::fabs(det) / 6.0 : 0.0;
+    out.state[t] = classify(det, valid);
+}
+
+}
+
+
+void HoudiniGeoComputeRestState(const std::vector<int>& tetIndices, const std::vector<double>& positions,
+                                double density, GeoRestState& out, const GeoCSR* pointTets) {
+    if (tetIndices.size() % 4 != 0) {
+        throw std::runtime_error("Tet indices size is not a multiple of 4");
+    }
+    if (positions.size() % 3 != 0) {
+        throw std::runtime_error("Positions size is not a multiple of 3");
+    }
+    const size_t pointCount = positions.size() / 3;
+    const size_t tetCount = tetIndices.size() / 4;
+    for (int v : tetIndices) {
+        if (v < 0 || size_t(v) >= pointCount) {
+            throw std::runtime_error("Tet index out of range: " + std::to_string(v));
+        }
+    }
+    if (pointTets && pointTets->rows() != pointCount) {
+        throw std::runtime_error("Point-tet table does not match the point count");
+    }
+
+    out.volume.resize(tetCount);
+    for (auto& column : out.DmInv) column.resize(tetCount);
+    out.state.resize(tetCount);
+    const int* tets = tetIndices.data();
+    const double* P = positions.data();
+
+    HoudiniGeoParallelFor(0, tetCount, grainSize, [&](size_t b, size_t e) {
+        size_t t = b;
+#ifdef HOUDINIGEO_HAS_SSE2
+        const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffll));
+        const __m128d tolerance = _mm_set1_pd(GeoDegenerateTetTolerance);
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128d sixth = _mm_set1_pd(1.0 / 6.0);
+        for (; t + 2 <= e; t += 2) {
+            // 两个四面体各占一个通道
+            const int* a = tets + 4 * t;
+            const int* n = a + 4;
+            __m128d c[3][3];
+            for (int k = 0; k < 3; k++) {
+                const __m128d origin = _mm_setr_pd(P[3 * a[0] + k], P[3 * n[0] + k]);
+                for (int v = 0; v < 3; v++) {
+                    c[v][k] = _mm_sub_pd(_mm_setr_pd(P[3 * a[v + 1] + k], P[3 * n[v + 1] + k]), origin);
+                }
+            }
+            __m128d rows[3][3];
+            for (int r = 0; r < 3; r++) {
+                const __m128d* u = c[(r + 1) % 3];
+                const __m128d* w = c[(r + 2) % 3];
+                rows[r][0] = _mm_sub_pd(_mm_mul_pd(u[1], w[2]), _mm_mul_pd(u[2], w[1]));
+                rows[r][1] = _mm_sub_pd(_mm_mul_pd(u[2], w[0]), _mm_mul_pd(u[0], w[2]));
+                rows[r][2] = _mm_sub_pd(_mm_mul_pd(u[0], w[1]), _mm_mul_pd(u[1], w[0]));
+            }
+            const __m128d det = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c[0][0], rows[0][0]), _mm_mul_pd(c[0][1], rows[0][1])),
+                                           _mm_mul_pd(c[0][2], rows[0][2]));
+            __m128d lengthSq = _mm_setzero_pd();
+            for (int v = 0; v < 3; v++) {
+                const __m128d l = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c[v][0], c[v][0]), _mm_mul_pd(c[v][1], c[v][1])),
+                                             _mm_mul_pd(c[v][2], c[v][2]));
+                lengthSq = _mm_max_pd(lengthSq, l);
+            }
+            const __m128d absDet = _mm_and_pd(det, absMask);
+            const __m128d valid = _mm_cmpgt_pd(absDet, _mm_mul_pd(tolerance, _mm_mul_pd(lengthSq, _mm_sqrt_pd(lengthSq))));
+            // 退化的通道先把det换成1再求倒数，乘完再按掩码清零（坐标为NaN时乘积也是NaN）
+            const __m128d invDet = _mm_div_pd(one, _mm_or_pd(_mm_and_pd(valid, det), _mm_andnot_pd(valid, one)));
+            for (int r = 0; r < 3; r++) {
+                for (int k = 0; k < 3; k++) {
+                    _mm_storeu_pd(out.DmInv[3 * r + k].data() + t, _mm_and_pd(valid, _mm_mul_pd(rows[r][k], invDet)));
+                }
+            }
+            _mm_storeu_pd(out.volume.data() + t, _mm_and_pd(valid, _mm_mul_pd(absDet, sixth)));
+            double dets[2];
+            _mm_storeu_pd(dets, det);
+            const int validBits = _mm_movemask_pd(valid);
+            out.state[t] = classify(dets[0], validBits & 1);
+            out.state[t + 1] = classify(dets[1], (validBits & 2) != 0);
+        }
+#endif
+        for (; t < e; t++) {
+            const int* a = tets + 4 * t;
+            restTet(P + 3 * a[0], P + 3 * a[1], P + 3 * a[2], P + 3 * a[3], t, out);
+        }
+    });
+
+    out.degenerateCount = 0;
+    out.invertedCount = 0;
+    for (GeoTetState s : out.state) {
+        out.degenerateCount += s == GeoTetState::Degenerate;
+        out.invertedCount += s == GeoTetState::Inverted;
+    }
+
+    // 每个点按四面体编号升序累加体积，两种方式的求和顺序相同
+    const double share = density / 4.0;
+    out.pointMass.assign(pointCount, 0.0);
+    if (pointTets) {
+        HoudiniGeoParallelFor(0, pointCount, grainSize, [&](size_t b, size_t e) {
+            for (size_t p = b; p < e; p++) {
+                double sum = 0.0;
+                for (const int* t = pointTets->begin(p); t != pointTets->end(p); ++t) sum += out.volume[*t];
+                out.pointMass[p] = sum * share;
+            }
+        });
+    } else {
+        for (size_t t = 0; t < tetCount; t++) {
+            for (int k = 0; k < 4; k++) out.pointMass[tets[4 * t + k]] += out.volume[t];
+        }
+        for (double& m : out.pointMass) m *= share;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "HoudiniGeoTopology.h"
+
+
+// 四面体FEM的静止状态，按分量分开存放（SoA），求解器可以按四面体编号连续地向量化读取。
+// Dm = [x1-x0, x2-x0, x3-x0]，第c列为第c+1个顶点相对第0个顶点的边。
+
+// |det(Dm)|不超过该比例乘最长边的立方时视为退化（正四面体约为0.7）。HoudiniGeoValidateMesh使用同一标准
+constexpr double GeoDegenerateTetTolerance = 1e-12;
+
+enum class GeoTetState : uint8_t {
+    Valid,
+    Degenerate,  // 体积（相对最长边的立方）接近0：体积、质量贡献和DmInv都记为0
+    Inverted,    // 朝向与Houdini的四面体相反：体积取绝对值，DmInv照常计算
+};
+
+struct GeoRestState {
+    std::vector<double> volume;                 // 每个四面体的静止体积，非负
+    std::array<std::vector<double>, 9> DmInv;   // DmInv[3*r+c][tet]为Dm^-1第r行第c列
+    std::vector<double> pointMass;              // 集中质量：每个四面体把density*volume/4分给4个顶点
+    std::vector<GeoTetState> state;             // 每个四面体的状态
+    size_t degenerateCount = 0;
+    size_t invertedCount = 0;
+
+    size_t tetCount() const { return volume.size(); }
+};
+
+// 并行计算静止体积、Dm^-1和集中质量，体积和逆矩阵两个四面体一组用SSE2计算。
+// 退化的四面体不会产生inf/NaN。pointTets不为空时（例如GeoTetAdjacency::pointTets）按点并行累加质量，
+// 否则按四面体顺序累加，两种方式结果相同
+void HoudiniGeoComputeRestState(const std::vector<int>& tetIndices, const std::vector<double>& positions,
+                                double density, GeoRestState& out, const GeoCSR* pointTets = nullptr);
@@ -0,0 +1,415 @@
+#include "HoudiniGeoScan.h"
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace HoudiniGeoScan {
+
+namespace {
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// pos指向开头的引号，返回结尾引号之后的位置
+size_t skipString(const char* data, size_t size, size_t pos) {
+    pos++;
+    while (pos < size) {
+        const char* q = static_cast<const char*>(std::memchr(data + pos, '"', size - pos));
+        if (q == nullptr) {
+            break;
+        }
+        size_t end = q - data;
+        // 数前面连续的反斜杠，奇数个说明这个引号被转义了
+        size_t backslashes = 0;
+        while (end - backslashes > pos && data[end - backslashes - 1] == '\\') {
+            backslashes++;
+        }
+        if (backslashes % 2 == 0) {
+            return end + 1;
+        }
+        pos = end + 1;
+    }
+    throw std::runtime_error("Unterminated string in geo file");
+}
+
+// pos指向开头的引号，解码到out（复用out的容量），pos移到结尾引号之后。\uXXXX不处理，返回false
+bool decodeString(const char* data, size_t size, size_t& pos, std::string& out) {
+    out.clear();
+    pos++;
+    while (pos < size) {
+        char c = data[pos++];
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (pos >= size) {
+            return false;
+        }
+        switch (data[pos++]) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        default: return false;
+        }
+    }
+    return false;
+}
+
+bool updateValue(const char* data, size_t size, size_t& pos, nlohmann::json& target, std::string& scratch) {
+    pos = skipWhitespace(data, size, pos);
+    if (pos >= size) {
+        return false;
+    }
+    const char c = data[pos];
+    if (c == '[') {
+        if (!target.is_array()) {
+            return false;
+        }
+        size_t count = 0;
+        pos = skipWhitespace(data, size, pos + 1);
+        while (pos < size && data[pos] != ']') {
+            if (count >= target.size() || !updateValue(data, size, pos, target[count], scratch)) {
+                return false;
+            }
+            count++;
+            pos = skipWhitespace(data, size, pos);
+            if (pos < size && data[pos] == ',') {
+                pos++;
+            }
+            pos = skipWhitespace(data, size, pos);
+        }
+        pos++;
+        return count == target.size();
+    }
+    if (c == '{') {
+        if (!target.is_object()) {
+            return false;
+        }
+        size_t count = 0;
+        pos = skipWhitespace(data, size, pos + 1);
+        while (pos < size && data[pos] != '}') {
+            if (data[pos] != '"' || !decodeString(data, size, pos, scratch)) {
+                return false;
+            }
+            auto it = target.find(scratch);
+            if (it == target.end()) {
+                return false;
+            }
+            pos = skipWhitespace(data, size, pos);
+            if (pos >= size || data[pos] != ':') {
+                return false;
+            }
+            pos++;
+            if (!updateValue(data, size, pos, *it, scratch)) {
+                return false;
+            }
+            count++;
+            pos = skipWhitespace(data, size, pos);
+            if (pos < size && data[pos] == ',') {
+                pos++;
+            }
+            pos = skipWhitespace(data, size, pos);
+        }
+        pos++;
+        return count == target.size();
+    }
+    if (c == '"') {
+        if (!target.is_string()) {
+            return false;
+        }
+        return decodeString(data, size, pos, target.get_ref<std::string&>());
+    }
+    if (c == 't' || c == 'f' || c == 'n') {
+        const char* word = c == 't' ? "true" : (c == 'f' ? "false" : "null");
+        const size_t len = std::strlen(word);
+        if (pos + len > size || std::memcmp(data + pos, word, len) != 0) {
+            return false;
+        }
+        pos += len;
+        if (c == 'n') target = nullptr;
+        else target = (c == 't');
+        return true;
+    }
+
+    // 数字：与nlohmann一致，带小数点或指数的为浮点，否则按正负分为无符号/有符号整数
+    const size_t end = skipValue(data, size, pos);
+    bool isFloat = false;
+    for (size_t i = pos; i < end; i++) {
+        if (data[i] == '.' || data[i] == 'e' || data[i] == 'E') {
+            isFloat = true;
+            break;
+        }
+    }
+    char* parsedEnd = nullptr;
+    if (isFloat) {
+        target = std::strtod(data + pos, &parsedEnd);
+    }
+    else if (c == '-') {
+        target = static_cast<nlohmann::json::number_integer_t>(std::strtoll(data + pos, &parsedEnd, 10));
+    }
+    else {
+        target = static_cast<nlohmann::json::number_unsigned_t>(std::strtoull(data + pos, &parsedEnd, 10));
+    }
+    if (parsedEnd != data + end) {
+        return false;
+    }
+    pos = end;
+    return true;
+}
+
+}
+
+size_t skipWhitespace(const char* data, size_t size, size_t pos) {
+    while (pos < size && isWhitespace(data[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+size_t skipValue(const char* data, size_t size, size_t pos) {
+    pos = skipWhitespace(data, size, pos);
+    if (pos >= size) {
+        throw std::runtime_error("Unexpected end of geo file");
+    }
+    char c = data[pos];
+    if (c == '"') {
+        return skipString(data, size, pos);
+    }
+    if (c == '[' || c == '{') {
+        size_t depth = 0;
+        while (pos < size) {
+            c = data[pos];
+            if (c == '"') {
+                pos = skipString(data, size, pos);
+                continue;
+            }
+            if (c == '[' || c == '{') {
+                depth++;
+            }
+            else if (c == ']' || c == '}') {
+                if (--depth == 0) {
+                    return pos + 1;
+                }
+            }
+            pos++;
+        }
+        throw std::runtime_error("Unbalanced brackets in geo file");
+    }
+    // 数字、true/false/null
+    while (pos < size && data[pos] != ',' && data[pos] != ']' && data[pos] != '}' && !isWhitespace(data[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+bool scanTopLevel(const char* data, size_t size, std::vector<Section>& sections) {
+    size_t count = 0;
+    size_t pos = skipWhitespace(data, size, 0);
+    if (pos >= size || data[pos] != '[') {
+        return false;
+    }
+    pos = skipWhitespace(data, size, pos + 1);
+    while (pos < size && data[pos] != ']') {
+        if (data[pos] != '"') {
+            return false;
+        }
+        size_t keyEnd = skipString(data, size, pos);
+        if (count == sections.size()) {
+            sections.emplace_back();
+        }
+        Section& section = sections[count++];
+        section.key.assign(data + pos + 1, keyEnd - pos - 2);
+
+        pos = skipWhitespace(data, size, keyEnd);
+        if (pos >= size || data[pos] != ',') {
+            return false;
+        }
+        pos = skipWhitespace(data, size, pos + 1);
+        section.value.begin = pos;
+        section.value.end = skipValue(data, size, pos);
+
+        pos = skipWhitespace(data, size, section.value.end);
+        if (pos < size && data[pos] == ',') {
+            pos = skipWhitespace(data, size, pos + 1);
+        }
+    }
+    sections.resize(count);
+    return pos < size;
+}
+
+const Section* findSection(const std::vector<Section>& sections, const char* key) {
+    for (const auto& section : sections) {
+        if (section.key == key) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+bool findPairValue(const char* data, Range pairList, const char* key, Range& value) {
+    size_t pos = skipWhitespace(data, pairList.end, pairList.begin);
+    if (pos >= pairList.end || data[pos] != '[') {
+        return false;
+    }
+    pos = skipWhitespace(data, pairList.end, pos + 1);
+    while (pos < pairList.end && data[pos] != ']') {
+        Range k{pos, skipValue(data, pairList.end, pos)};
+        pos = skipWhitespace(data, pairList.end, k.end);
+        if (pos >= pairList.end || data[pos] != ',') {
+            return false;
+        }
+        pos = skipWhitespace(data, pairList.end, pos + 1);
+        Range v{pos, skipValue(data, pairList.end, pos)};
+        if (stringEquals(data, k, key)) {
+            value = v;
+            return true;
+        }
+        pos = skipWhitespace(data, pairList.end, v.end);
+        if (pos < pairList.end && data[pos] == ',') {
+            pos = skipWhitespace(data, pairList.end, pos + 1);
+        }
+    }
+    return false;
+}
+
+bool arrayElement(const char* data, Range array, size_t index, Range& value) {
+    size_t pos = skipWhitespace(data, array.end, array.begin);
+    if (pos >= array.end || data[pos] != '[') {
+        return false;
+    }
+    pos = skipWhitespace(data, array.end, pos + 1);
+    for (size_t i = 0; pos < array.end && data[pos] != ']'; i++) {
+        const size_t valueEnd = skipValue(data, array.end, pos);
+        if (i == index) {
+            value = Range{pos, valueEnd};
+            return true;
+        }
+        pos = skipWhitespace(data, array.end, valueEnd);
+        if (pos < array.end && data[pos] == ',') {
+            pos = skipWhitespace(data, array.end, pos + 1);
+        }
+    }
+    return false;
+}
+
+bool stringEquals(const char* data, Range value, const char* s) {
+    const size_t len = std::strlen(s);
+    return value.size() == len + 2 && data[value.begin] == '"' &&
+           std::memcmp(data + value.begin + 1, s, len) == 0;
+}
+
+bool findAttribute(const char* data, Range attributes, const char* attributeClass, const char* name,
+                   Range& values, int& tupleSize) {
+    Range classAttributes;
+    if (!findPairValue(data, attributes, attributeClass, classAttributes)) {
+        return false;
+    }
+    Range attr;
+    for (size_t i = 0; arrayElement(data, classAttributes, i, attr); i++) {
+        Range metadata, attrData, attrName;
+        if (!arrayElement(data, attr, 0, metadata) ||
+            !arrayElement(data, attr, 1, attrData) ||
+            !findPairValue(data, metadata, "name", attrName) ||
+            !stringEquals(data, attrName, name)) {
+            continue;
+        }
+        Range size, attrValues;
+        tupleSize = 1;
+        if (findPairValue(data, attrData, "size", size)) {
+            tupleSize = std::atoi(data + size.begin);
+        }
+        if (!findPairValue(data, attrData, "values", attrValues)) {
+            return false;
+        }
+        return findPairValue(data, attrValues, "tuples", values) ||
+               findPairValue(data, attrValues, "arrays", values);
+    }
+    return false;
+}
+
+// 跳过括号、逗号和空白，停在下一个数字上
+bool NumberReader::nextNumber() {
+    while (pos < end) {
+        const char c = data[pos];
+        if (c == '[' || c == ']' || c == ',' || isWhitespace(c)) {
+            pos++;
+            continue;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return true;
+        }
+        throw std::runtime_error("Unexpected value in numeric array");
+    }
+    return false;
+}
+
+size_t NumberReader::read(double* out, size_t count) {
+    size_t n = 0;
+    while (n < count && nextNumber()) {
+        char* parsedEnd = nullptr;
+        out[n++] = std::strtod(data + pos, &parsedEnd);
+        if (parsedEnd == data + pos) {
+            throw std::runtime_error("Invalid number in numeric array");
+        }
+        pos = parsedEnd - data;
+    }
+    return n;
+}
+
+size_t NumberReader::read(float* out, size_t count) {
+    size_t n = 0;
+    while (n < count && nextNumber()) {
+        char* parsedEnd = nullptr;
+        out[n++] = std::strtof(data + pos, &parsedEnd);
+        if (parsedEnd == data + pos) {
+            throw std::runtime_error("Invalid number in numeric array");
+        }
+        pos = parsedEnd - data;
+    }
+    return n;
+}
+
+size_t NumberReader::read(int* out, size_t count) {
+    size_t n = 0;
+    while (n < count && nextNumber()) {
+        char* parsedEnd = nullptr;
+        out[n++] = static_cast<int>(std::strtol(data + pos, &parsedEnd, 10));
+        if (parsedEnd == data + pos) {
+            throw std::runtime_error("Invalid number in numeric array");
+        }
+        pos = parsedEnd - data;
+    }
+    return n;
+}
+
+size_t NumberReader::skip(size_t count) {
+    size_t n = 0;
+    while (n < count && nextNumber()) {
+        pos = skipValue(data, end, pos);
+        n++;
+    }
+    return n;
+}
+
+bool updateInPlace(const char* data, size_t size, Range range, nlohmann::json& target, std::string& scratch) {
+    // 范围必须落在缓冲区内，否则按结构不一致处理，由调用方完整解析
+    if (range.begin > range.end || range.end > size) {
+        return false;
+    }
+    size_t pos = range.begin;
+    if (!updateValue(data, range.end, pos, target, scratch)) {
+        return false;
+    }
+    return skipWhitespace(data, range.end, pos) == range.end;
+}
+
+}
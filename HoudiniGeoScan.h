@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "json.hpp"
+
+// 文本.geo的轻量扫描：不建DOM，只找出顶层pair list中各个值的字节范围，
+// 用于对拓扑段做字节哈希、按需只解析部分段。
+namespace HoudiniGeoScan {
+
+struct Range {
+    size_t begin = 0;
+    size_t end = 0;
+    size_t size() const { return end - begin; }
+};
+
+struct Section {
+    std::string key;  // 顶层的键，例如 "topology"
+    Range value;      // 对应值的字节范围
+};
+
+size_t skipWhitespace(const char* data, size_t size, size_t pos);
+
+// 跳过从pos开始的一个JSON值，返回值结束后的位置
+size_t skipValue(const char* data, size_t size, size_t pos);
+
+// 扫描顶层 ["key",value,"key",value,...]。sections的容量会被复用。格式不符时返回false。
+bool scanTopLevel(const char* data, size_t size, std::vector<Section>& sections);
+
+const Section* findSection(const std::vector<Section>& sections, const char* key);
+
+// 在pair list（["key",value,...]）的范围内找key对应的值
+bool findPairValue(const char* data, Range pairList, const char* key, Range& value);
+
+// 数组中第index个元素
+bool arrayElement(const char* data, Range array, size_t index, Range& value);
+
+// 字符串值（不处理转义）是否等于s
+bool stringEquals(const char* data, Range value, const char* s);
+
+// 在attributes段中找某一类（"pointattributes"、"primitiveattributes"等）里名为name的属性，
+// 返回数值所在的范围（tuples或arrays）和每个元素的分量数
+bool findAttribute(const char* data, Range attributes, const char* attributeClass, const char* name,
+                   Range& values, int& tupleSize);
+
+// 按顺序读出range内的数字，忽略嵌套的括号，例如 [[x,y,z],[x,y,z]] 依次得到x,y,z,x,y,z。
+// 直接写入调用方的内存，不建DOM。data需以'\0'结尾。
+class NumberReader {
+public:
+    NumberReader(const char* data, Range range) : data(data), pos(range.begin), end(range.end) {}
+
+    // 读出至多count个数字，返回实际读到的个数
+    size_t read(double* out, size_t count);
+    size_t read(float* out, size_t count);
+    size_t read(int* out, size_t count);
+    size_t skip(size_t count);
+
+private:
+    bool nextNumber();
+
+    const char* data;
+    size_t pos;
+    size_t end;
+};
+
+// 用range中的JSON文本就地更新结构相同的target：数字、布尔直接赋值，字符串复用原有容量，
+// 数组长度、对象的键必须与target一致。结构不一致时返回false（target可能已被部分改写，调用方应重新完整解析）。
+// 结构一致时不分配内存。data需以'\0'结尾（例如std::string的data()），size为data的长度，
+// range超出[0, size)时返回false。scratch用于对象键的查找。
+bool updateInPlace(const char* data, size_t size, Range range, nlohmann::json& target, std::string& scratch);
+
+}
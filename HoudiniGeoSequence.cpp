@@ -0,0 +1,567 @@
+#include "HoudiniGeoSequence.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "HoudiniGeoScan.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HOUDINIGEO_HAS_SSE2
+#endif
+
+
+namespace {
+
+std::shared_ptr<const GeoTopology> copyTopology(const HoudiniGeoIO& geo, uint64_t fingerprint) {
+    auto topology = std::make_shared<GeoTopology>();
+    topology->fingerprint = fingerprint;
+    topology->indices = geo.getIndicesRef();
+    topology->tet_indices = geo.getTetIndicesRef();
+    topology->surface_indices = geo.getSurfaceIndicesRef();
+    topology->is_surface_point = geo.getIsSurfacePointRef();
+    return topology;
+}
+
+// 从文本.geo的开头读到info段为止，取出info.time（没有时为0），不读后面的拓扑和位置。
+// info通常在topology之前，一般只需读第一块。不是文本格式时返回false
+bool scanFileTime(const std::string& path, double& time) {
+    if (HoudiniGeoIO::formatFromPath(path) != GeoFileFormat::Ascii) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    std::string buffer;
+    size_t chunk = size_t(1) << 16;
+    for (bool eof = false; !eof; chunk *= 2) {
+        const size_t old = buffer.size();
+        buffer.resize(old + chunk);
+        file.read(&buffer[old], static_cast<std::streamsize>(chunk));
+        buffer.resize(old + static_cast<size_t>(file.gcount()));
+        eof = !file;
+
+        const char* data = buffer.data();
+        const size_t size = buffer.size();
+        try {
+            size_t pos = HoudiniGeoScan::skipWhitespace(data, size, 0);
+            if (pos < size && data[pos] != '[') {
+                return false;
+            }
+            pos = HoudiniGeoScan::skipWhitespace(data, size, pos + 1);
+            while (pos < size && data[pos] != ']') {
+                const HoudiniGeoScan::Range key{pos, HoudiniGeoScan::skipValue(data, size, pos)};
+                pos = HoudiniGeoScan::skipWhitespace(data, size, key.end);
+                if (pos >= size) break;
+                if (data[pos] != ',') {
+                    return false;
+                }
+                const HoudiniGeoScan::Range value{HoudiniGeoScan::skipWhitespace(data, size, pos + 1),
+                                                  HoudiniGeoScan::skipValue(data, size, pos + 1)};
+                if (value.end >= size) break;  // 值可能还没读完
+                if (HoudiniGeoScan::stringEquals(data, key, "info")) {
+                    const nlohmann::json info = nlohmann::json::parse(data + value.begin, data + value.end);
+                    const bool hasTime = info.is_object() && info.contains("time") && info["time"].is_number();
+                    time = hasTime ? info["time"].get<double>() : 0.0;
+                    return true;
+                }
+                pos = HoudiniGeoScan::skipWhitespace(data, size, value.end);
+                if (pos < size && data[pos] == ',') {
+                    pos = HoudiniGeoScan::skipWhitespace(data, size, pos + 1);
+                }
+            }
+            if (pos < size) {
+                time = 0.0;  // 顶层已结束，没有info
+                return true;
+            }
+        }
+        catch (const std::runtime_error&) {
+            // 读到的部分在值的中间截断，继续读
+        }
+    }
+    time = 0.0;
+    return true;
+}
+
+size_t topologyBytes(const GeoTopology& topology) {
+    return sizeof(GeoTopology)
+        + (topology.indices.capacity() + topology.tet_indices.capacity() + topology.surface_indices.capacity()) * sizeof(int)
+        + topology.is_surface_point.capacity() / 8;
+}
+
+}
+
+
+HoudiniGeoAsyncWriter::HoudiniGeoAsyncWriter(const HoudiniGeoIO& templateGeo, size_t maxQueueDepth)
+    : geo(templateGeo), maxQueueDepth(std::max<size_t>(maxQueueDepth, 1)) {
+    worker = std::thread([this] { writerLoop(); });
+}
+
+HoudiniGeoAsyncWriter::~HoudiniGeoAsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    worker.join();
+}
+
+std::future<void> HoudiniGeoAsyncWriter::submit(const std::string& outputPath, std::vector<double>&& positions) {
+    return enqueue(outputPath, std::move(positions), nullptr);
+}
+
+std::future<void> HoudiniGeoAsyncWriter::submitSwap(const std::string& outputPath, std::vector<double>& positions) {
+    const size_t n = positions.size();
+    std::vector<double> recycled;
+    std::future<void> result = enqueue(outputPath, std::move(positions), &recycled);
+    recycled.resize(n);
+    positions = std::move(recycled);
+    return result;
+}
+
+std::future<void> HoudiniGeoAsyncWriter::enqueue(const std::string& outputPath, std::vector<double>&& positions,
+                                                 std::vector<double>* recycled) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // 背压：等到有空位
+    queueChanged.wait(lock, [this] { return queue.size() + inFlight < maxQueueDepth; });
+    if (recycled && !freeBuffers.empty()) {
+        *recycled = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+    }
+
+    Job job;
+    job.path = outputPath;
+    job.positions = std::move(positions);
+    std::future<void> result = job.done.get_future();
+    queue.push_back(std::move(job));
+    // 新入队的帧占了一份，回收池相应让出
+    while (!freeBuffers.empty() && queue.size() + inFlight + freeBuffers.size() > maxQueueDepth) {
+        freeBuffers.pop_back();
+    }
+    lock.unlock();
+    queueChanged.notify_all();
+    return result;
+}
+
+void HoudiniGeoAsyncWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    queueChanged.wait(lock, [this] { return queue.empty() && inFlight == 0; });
+}
+
+size_t HoudiniGeoAsyncWriter::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + inFlight;
+}
+
+void HoudiniGeoAsyncWriter::writerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;  // stopping且队列已清空
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+            inFlight++;
+        }
+
+        try {
+            geo.setPositions(job.positions);
+            geo.write(job.path);
+            job.done.set_value();
+        }
+        catch (...) {
+            job.done.set_exception(std::current_exception());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inFlight--;
+            // 回收缓冲区，供submitSwap换回给调用方；排队+正在写+回收池不超过maxQueueDepth
+            if (queue.size() + inFlight + freeBuffers.size() < maxQueueDepth) {
+                freeBuffers.push_back(std::move(job.positions));
+            }
+        }
+        queueChanged.notify_all();
+    }
+}
+
+
+HoudiniGeoSequenceReader::HoudiniGeoSequenceReader(const std::string& pattern, int startFrame, int endFrame, Options options)
+    : pattern(pattern), startFrame(startFrame), endFrame(endFrame), options(options),
+      nextToLoad(startFrame), nextToHand(startFrame) {
+    const unsigned numThreads = std::max(1u, options.threads);
+    for (unsigned i = 0; i < numThreads; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+HoudiniGeoSequenceReader::~HoudiniGeoSequenceReader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+std::unique_ptr<GeoFrame> HoudiniGeoSequenceReader::next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (nextToHand > endFrame) {
+        return nullptr;
+    }
+    changed.wait(lock, [this] { return ready.count(nextToHand) > 0; });
+    auto it = ready.find(nextToHand);
+    Slot slot = std::move(it->second);
+    ready.erase(it);
+    nextToHand++;
+    lock.unlock();
+    changed.notify_all();
+
+    if (slot.error) {
+        std::rethrow_exception(slot.error);
+    }
+    return std::move(slot.frame);
+}
+
+void HoudiniGeoSequenceReader::recycle(std::unique_ptr<GeoFrame> frame) {
+    if (!frame) {
+        return;
+    }
+    frame->topology.reset();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeFrames.size() < options.prefetch + 1) {
+        freeFrames.push_back(std::move(frame));
+    }
+}
+
+// 拓扑与上一份相同则共用，否则复制一份新的
+std::shared_ptr<const GeoTopology> HoudiniGeoSequenceReader::shareTopology(const HoudiniGeoIO& geo) {
+    const uint64_t fingerprint = geo.topologyFingerprint();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastTopology && lastTopology->fingerprint == fingerprint) {
+            return lastTopology;
+        }
+    }
+    auto topology = copyTopology(geo, fingerprint);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lastTopology = topology;
+    return topology;
+}
+
+void HoudiniGeoSequenceReader::workerLoop() {
+    HoudiniGeoIO geo;  // 每个线程复用一个读取对象
+    geo.setReuseBuffers(true);
+    for (;;) {
+        int frameNumber;
+        std::unique_ptr<GeoFrame> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] {
+                return stopping || (nextToLoad <= endFrame &&
+                                    static_cast<size_t>(nextToLoad - nextToHand) < std::max<size_t>(options.prefetch, 1));
+            });
+            if (stopping) {
+                return;
+            }
+            frameNumber = nextToLoad++;
+            if (!freeFrames.empty()) {
+                frame = std::move(freeFrames.back());
+                freeFrames.pop_back();
+            }
+        }
+        if (!frame) {
+            frame = std::make_unique<GeoFrame>();
+        }
+
+        Slot slot;
+        try {
+            const std::string path = expandFramePattern(pattern, frameNumber);
+            if (options.tetWithSurface) geo.readTetWithSurface(path);
+            else geo.read(path);
+
+            const auto& pos = geo.getPositionsRef();
+            frame->frame = frameNumber;
+            frame->time = geo.getTime();
+            frame->positions.assign(pos.begin(), pos.end());
+            frame->topology = shareTopology(geo);
+            slot.frame = std::move(frame);
+        }
+        catch (...) {
+            slot.error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[frameNumber] = std::move(slot);
+        }
+        changed.notify_all();
+    }
+}
+
+std::string HoudiniGeoSequenceReader::expandFramePattern(const std::string& pattern, int frame) {
+    std::string out;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] == '$' && i + 1 < pattern.size() && pattern[i + 1] == 'F') {
+            size_t j = i + 2;
+            int width = 0;
+            while (j < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[j]))) {
+                width = width * 10 + (pattern[j] - '0');
+                j++;
+            }
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%0*d", width, frame);
+            out += buf;
+            i = j - 1;
+        }
+        else {
+            out.push_back(pattern[i]);
+        }
+    }
+    return out;
+}
+
+
+HoudiniGeoFrameCache::HoudiniGeoFrameCache(const std::string& pattern, Options options)
+    : pattern(pattern), options(options) {
+}
+
+std::shared_ptr<const GeoFrame> HoudiniGeoFrameCache::get(int frameNumber) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(frameNumber);
+    if (it != entries.end()) {
+        hitCount++;
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+        return it->second.frame;
+    }
+    auto pending = loading.find(frameNumber);
+    if (pending != loading.end()) {
+        // 其他线程正在读这一帧，等它的结果，不重复读文件
+        hitCount++;
+        auto result = pending->second;
+        lock.unlock();
+        return result.get();
+    }
+    missCount++;
+
+    std::promise<std::shared_ptr<const GeoFrame>> promise;
+    loading[frameNumber] = promise.get_future().share();
+    std::unique_ptr<HoudiniGeoIO> geo;
+    if (!idleReaders.empty()) {
+        geo = std::move(idleReaders.back());
+        idleReaders.pop_back();
+    }
+    lock.unlock();
+
+    auto frame = std::make_shared<GeoFrame>();
+    try {
+        if (!geo) {
+            geo = std::make_unique<HoudiniGeoIO>();
+            geo->setReuseBuffers(true);
+        }
+        const std::string path = HoudiniGeoSequenceReader::expandFramePattern(pattern, frameNumber);
+        if (options.tetWithSurface) geo->readTetWithSurface(path);
+        else geo->read(path);
+        frame->frame = frameNumber;
+        frame->time = geo->getTime();
+        frame->positions = geo->getPositionsRef();
+    }
+    catch (...) {
+        lock.lock();
+        loading.erase(frameNumber);
+        if (geo) idleReaders.push_back(std::move(geo));
+        lock.unlock();
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    lock.lock();
+    frame->topology = acquireTopology(*geo);
+    idleReaders.push_back(std::move(geo));
+    loading.erase(frameNumber);
+
+    Entry& entry = entries[frameNumber];
+    entry.frame = frame;
+    entry.bytes = sizeof(GeoFrame) + frame->positions.capacity() * sizeof(double);
+    lru.push_front(frameNumber);
+    entry.lruPos = lru.begin();
+    usedBytes += entry.bytes;
+
+    evict(1);
+    lock.unlock();
+    promise.set_value(frame);
+    return frame;
+}
+
+bool HoudiniGeoFrameCache::contains(int frameNumber) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.count(frameNumber) > 0;
+}
+
+void HoudiniGeoFrameCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    evict(0);
+}
+
+void HoudiniGeoFrameCache::setBudget(size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    options.budgetBytes = budgetBytes;
+    evict(1);
+}
+
+size_t HoudiniGeoFrameCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t HoudiniGeoFrameCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+size_t HoudiniGeoFrameCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+size_t HoudiniGeoFrameCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+// 同一指纹的拓扑只保留一份，并计入一次内存
+std::shared_ptr<const GeoTopology> HoudiniGeoFrameCache::acquireTopology(const HoudiniGeoIO& geo) {
+    const uint64_t fingerprint = geo.topologyFingerprint();
+    SharedTopology& shared = topologies[fingerprint];
+    if (!shared.topology) {
+        shared.topology = copyTopology(geo, fingerprint);
+        shared.bytes = topologyBytes(*shared.topology);
+        usedBytes += shared.bytes;
+    }
+    shared.users++;
+    return shared.topology;
+}
+
+void HoudiniGeoFrameCache::releaseTopology(uint64_t fingerprint) {
+    auto it = topologies.find(fingerprint);
+    if (it == topologies.end()) {
+        return;
+    }
+    if (--it->second.users == 0) {
+        usedBytes -= it->second.bytes;
+        topologies.erase(it);
+    }
+}
+
+// 从最久未用的一端淘汰，直到不超预算或只剩keep帧
+void HoudiniGeoFrameCache::evict(size_t keep) {
+    while (entries.size() > keep && (keep == 0 || usedBytes > options.budgetBytes)) {
+        auto it = entries.find(lru.back());
+        usedBytes -= it->second.bytes;
+        releaseTopology(it->second.frame->topology->fingerprint);
+        entries.erase(it);
+        lru.pop_back();
+    }
+}
+
+
+void HoudiniGeoLerp(const double* a, const double* b, double w, double* out, size_t n) {
+    size_t i = 0;
+#ifdef HOUDINIGEO_HAS_SSE2
+    const __m128d vw = _mm_set1_pd(w);
+    for (; i + 4 <= n; i += 4) {
+        __m128d a0 = _mm_loadu_pd(a + i);
+        __m128d a1 = _mm_loadu_pd(a + i + 2);
+        __m128d d0 = _mm_sub_pd(_mm_loadu_pd(b + i), a0);
+        __m128d d1 = _mm_sub_pd(_mm_loadu_pd(b + i + 2), a1);
+        _mm_storeu_pd(out + i, _mm_add_pd(a0, _mm_mul_pd(vw, d0)));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(a1, _mm_mul_pd(vw, d1)));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] + w * (b[i] - a[i]);
+    }
+}
+
+
+HoudiniGeoTimeSampler::HoudiniGeoTimeSampler(HoudiniGeoFrameCache& cache, int startFrame, int endFrame, double fps)
+    : cache(cache), startFrame(startFrame), endFrame(std::max(startFrame, endFrame)), fps(fps > 0.0 ? fps : 24.0) {
+}
+
+// 帧在cache中时直接取，否则只扫描文件开头的info；二进制格式只能整帧读入
+double HoudiniGeoTimeSampler::fileTime(int frame) {
+    auto it = fileTimes.find(frame);
+    if (it != fileTimes.end()) {
+        return it->second;
+    }
+    double time = 0.0;
+    if (cache.contains(frame) ||
+        !scanFileTime(HoudiniGeoSequenceReader::expandFramePattern(cache.getPattern(), frame), time)) {
+        time = cache.get(frame)->time;
+    }
+    fileTimes[frame] = time;
+    return time;
+}
+
+GeoTimeSample HoudiniGeoTimeSampler::sample(double time, std::vector<double>& positions) {
+    GeoTimeSample result;
+    if (startFrame == endFrame) {
+        auto only = cache.get(startFrame);
+        result.frame0 = result.frame1 = startFrame;
+        result.topology = only->topology;
+        positions = only->positions;
+        return result;
+    }
+
+    // 按fps估计；文件时间递增而估计的区间不含time时，在估计的一侧按文件时间二分查找
+    const double guess = std::floor(1.0 + time * fps + 1e-9);
+    int f0 = static_cast<int>(std::min<double>(std::max<double>(guess, startFrame), endFrame - 1));
+    const double t0 = fileTime(f0), t1 = fileTime(f0 + 1);
+    if (t1 > t0 && (time < t0 || time > t1)) {
+        // 找lo使 fileTime(lo) <= time < fileTime(hi)，hi = lo + 1
+        int lo = time < t0 ? startFrame : f0 + 1;
+        int hi = time < t0 ? f0 : endFrame;
+        if (time >= fileTime(hi)) {
+            lo = hi - 1;
+        }
+        while (hi - lo > 1) {
+            const int mid = lo + (hi - lo) / 2;
+            if (fileTime(mid) <= time) lo = mid;
+            else hi = mid;
+        }
+        f0 = std::min(lo, endFrame - 1);
+    }
+    std::shared_ptr<const GeoFrame> a = cache.get(f0), b = cache.get(f0 + 1);
+    fileTimes[a->frame] = a->time;
+    fileTimes[b->frame] = b->time;
+
+    if (a->topology->fingerprint != b->topology->fingerprint || a->positions.size() != b->positions.size()) {
+        throw std::runtime_error("Cannot interpolate between frames " + std::to_string(a->frame) + " and " +
+                                 std::to_string(b->frame) + ": topology changed");
+    }
+
+    // 这两帧的时间不递增（包括没有记录时间）时按 (frame-1)/fps 插值
+    double ta = a->time, tb = b->time;
+    if (!(tb > ta)) {
+        ta = (a->frame - 1) / fps;
+        tb = (b->frame - 1) / fps;
+    }
+    double w = (time - ta) / (tb - ta);
+    w = std::min(1.0, std::max(0.0, w));
+
+    result.frame0 = a->frame;
+    result.frame1 = b->frame;
+    result.weight = w;
+    result.topology = a->topology;
+    positions.resize(a->positions.size());
+    HoudiniGeoLerp(a->positions.data(), b->positions.data(), w, positions.data(), positions.size());
+    return result;
+}
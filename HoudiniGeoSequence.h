@@ -0,0 +1,233 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "HoudiniGeoIO.h"
+
+
+// 一个序列中各帧共享的拓扑（不可变，多帧通过shared_ptr共用同一份）
+struct GeoTopology {
+    uint64_t fingerprint = 0;
+    std::vector<int> indices;
+    std::vector<int> tet_indices;
+    std::vector<int> surface_indices;
+    std::vector<bool> is_surface_point;
+};
+
+// 一帧解码后的数据
+struct GeoFrame {
+    int frame = 0;
+    double time = 0.0;   // info.time
+    std::vector<double> positions;
+    std::shared_ptr<const GeoTopology> topology;
+};
+
+
+// 异步逐帧导出。
+// 以一个已读入的geo为模板（拓扑、其它属性不变），每帧只交出新的位置数组，
+// 由后台线程序列化并写盘，求解器线程不再等待IO。
+// 队列深度有上限：排队+正在写的帧数达到maxQueueDepth时submit会阻塞（背压）。
+// 回收池也计入上限（排队+正在写+回收池不超过maxQueueDepth），加上调用方手里的一份，
+// 内存最多占用 maxQueueDepth+1 份位置数组。
+class HoudiniGeoAsyncWriter {
+public:
+    explicit HoudiniGeoAsyncWriter(const HoudiniGeoIO& templateGeo, size_t maxQueueDepth = 2);
+    ~HoudiniGeoAsyncWriter(); // 等待所有帧写完
+
+    HoudiniGeoAsyncWriter(const HoudiniGeoAsyncWriter&) = delete;
+    HoudiniGeoAsyncWriter& operator=(const HoudiniGeoAsyncWriter&) = delete;
+
+    // 交出位置数组的所有权。返回的future在该帧写完后就绪，写出失败时抛出异常。
+    std::future<void> submit(const std::string& outputPath, std::vector<double>&& positions);
+
+    // 双缓冲：positions被换入队列，同时换回一块写完后回收的同尺寸缓冲区（内容未定义）。
+    std::future<void> submitSwap(const std::string& outputPath, std::vector<double>& positions);
+
+    // 阻塞直到队列中的帧全部写完
+    void flush();
+
+    size_t pending() const;
+
+private:
+    struct Job {
+        std::string path;
+        std::vector<double> positions;
+        std::promise<void> done;
+    };
+
+    // 入队；recycled不为空时在同一次加锁中从回收池取一块缓冲区
+    std::future<void> enqueue(const std::string& outputPath, std::vector<double>&& positions, std::vector<double>* recycled);
+    void writerLoop();
+
+    HoudiniGeoIO geo;
+    const size_t maxQueueDepth;
+
+    mutable std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<Job> queue;
+    size_t inFlight = 0;  // 已出队正在写的帧
+    std::vector<std::vector<double>> freeBuffers;
+    bool stopping = false;
+    std::thread worker;
+};
+
+
+// 带后台预读的帧序列读取。
+// 文件名模板支持Houdini的 $F 和补零的 $F4 等写法，例如 "cache/frame.$F4.geo"。
+// 工作线程提前读取并解析之后的prefetch帧，next()按帧号顺序交出已就绪的帧，
+// 用完的帧可以recycle()交还，位置数组的容量会留给后面的帧复用。
+struct GeoSequenceOptions {
+    size_t prefetch = 4;         // 最多提前读取的帧数
+    unsigned threads = 2;        // 读取线程数
+    bool tetWithSurface = false; // 用readTetWithSurface()读取每帧
+};
+
+class HoudiniGeoSequenceReader {
+public:
+    using Options = GeoSequenceOptions;
+
+    HoudiniGeoSequenceReader(const std::string& pattern, int startFrame, int endFrame, Options options = Options());
+    ~HoudiniGeoSequenceReader();
+
+    HoudiniGeoSequenceReader(const HoudiniGeoSequenceReader&) = delete;
+    HoudiniGeoSequenceReader& operator=(const HoudiniGeoSequenceReader&) = delete;
+
+    // 取下一帧（阻塞到就绪），序列结束返回nullptr。该帧读取失败时抛出异常。
+    std::unique_ptr<GeoFrame> next();
+
+    void recycle(std::unique_ptr<GeoFrame> frame);
+
+    static std::string expandFramePattern(const std::string& pattern, int frame);
+
+private:
+    struct Slot {
+        std::unique_ptr<GeoFrame> frame;
+        std::exception_ptr error;
+    };
+
+    void workerLoop();
+    std::shared_ptr<const GeoTopology> shareTopology(const HoudiniGeoIO& geo);
+
+    const std::string pattern;
+    const int startFrame;
+    const int endFrame;
+    const Options options;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    int nextToLoad;
+    int nextToHand;
+    std::map<int, Slot> ready;
+    std::vector<std::unique_ptr<GeoFrame>> freeFrames;
+    std::shared_ptr<const GeoTopology> lastTopology;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
+
+
+// 按内存预算缓存解码后的帧，LRU淘汰，适合来回拖动时间轴反复访问同一批帧。
+// 拓扑相同的帧共用一份GeoTopology（按指纹引用计数），缓存N帧的开销是一份拓扑加N个位置数组。
+struct GeoFrameCacheOptions {
+    size_t budgetBytes = size_t(1) << 30; // 位置数组与拓扑合计的字节上限
+    bool tetWithSurface = false;          // 用readTetWithSurface()读取每帧
+};
+
+class HoudiniGeoFrameCache {
+public:
+    using Options = GeoFrameCacheOptions;
+
+    explicit HoudiniGeoFrameCache(const std::string& pattern, Options options = Options());
+
+    HoudiniGeoFrameCache(const HoudiniGeoFrameCache&) = delete;
+    HoudiniGeoFrameCache& operator=(const HoudiniGeoFrameCache&) = delete;
+
+    // 命中则直接返回，否则读取该帧并放入缓存。返回的帧被淘汰后在调用方手里仍然有效。
+    // 读文件时不持有锁，不同帧可以并发读取；同一帧正在读取时，其他调用等待这一次的结果（失败时一起抛出异常）。
+    std::shared_ptr<const GeoFrame> get(int frame);
+
+    bool contains(int frame) const;
+    void clear();
+
+    const std::string& getPattern() const { return pattern; }
+
+    // 调小预算会立即淘汰。刚读入的一帧即使超出预算也会保留。
+    void setBudget(size_t budgetBytes);
+
+    size_t size() const;
+    size_t bytes() const;  // 当前占用（位置数组 + 不同拓扑各一份）
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const GeoFrame> frame;
+        std::list<int>::iterator lruPos;
+        size_t bytes = 0;
+    };
+    struct SharedTopology {
+        std::shared_ptr<const GeoTopology> topology;
+        size_t users = 0;   // 缓存中引用它的帧数
+        size_t bytes = 0;
+    };
+
+    std::shared_ptr<const GeoTopology> acquireTopology(const HoudiniGeoIO& geo);
+    void releaseTopology(uint64_t fingerprint);
+    void evict(size_t keep);
+
+    const std::string pattern;
+    Options options;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<HoudiniGeoIO>> idleReaders;  // 空闲的读取对象，复用缓冲区
+    std::unordered_map<int, std::shared_future<std::shared_ptr<const GeoFrame>>> loading;  // 正在读取的帧
+    std::list<int> lru;  // 头部最近使用
+    std::unordered_map<int, Entry> entries;
+    std::unordered_map<uint64_t, SharedTopology> topologies;
+    size_t usedBytes = 0;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+};
+
+
+// out[i] = a[i] + w*(b[i]-a[i])，x86上用SSE2每次处理两个double
+void HoudiniGeoLerp(const double* a, const double* b, double w, double* out, size_t n);
+
+// 一次按时间采样的结果
+struct GeoTimeSample {
+    int frame0 = 0;       // 前后两帧
+    int frame1 = 0;
+    double weight = 0.0;  // 0取frame0，1取frame1
+    std::shared_ptr<const GeoTopology> topology;
+};
+
+// 按时间（info.time）而不是帧号访问序列，在前后两帧之间线性插值位置，供子步求解器在任意时刻采样碰撞体。
+// 先按Houdini的约定 time = (frame-1)/fps 估计所在的帧，估计不对时按文件里记录的时间二分查找，
+// 查找时文本.geo只读开头的info段，不解码位置，只有插值的两帧被读入cache。
+// 二进制格式读不出时间就只能整帧解码，查找经过的帧也会进入cache。
+// 两帧的时间不递增（包括文件没有记录时间，都为0）时按 (frame-1)/fps 插值。
+class HoudiniGeoTimeSampler {
+public:
+    HoudiniGeoTimeSampler(HoudiniGeoFrameCache& cache, int startFrame, int endFrame, double fps = 24.0);
+
+    // positions被改写为time时刻的位置。超出序列范围时取首帧/末帧。
+    // 前后两帧拓扑不同时抛出异常。
+    GeoTimeSample sample(double time, std::vector<double>& positions);
+
+private:
+    double fileTime(int frame);
+
+    HoudiniGeoFrameCache& cache;
+    const int startFrame;
+    const int endFrame;
+    const double fps;
+    std::map<int, double> fileTimes;  // 已知的各帧文件时间
+};
@@ -0,0 +1,389 @@
+#include "HoudiniGeoStream.h"
+#include "HoudiniGeoIO.h"
+#include "HoudiniGeoBinary.h"
+#include "HoudiniGeoGzip.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+
+// 当前所在的JSON容器在geo结构中的位置
+enum class Role {
+    Other, Root, Info,
+    Topology, PointRef, Indices,
+    Attributes, PointAttributes, Attribute, AttributeMeta, AttributeData, AttributeValues,
+    Tuples, Tuple, Arrays, ArrayValues,
+    Primitives, Run, RunType, RunAttribs,
+    Groups, Group, GroupMeta, GroupData, Selection, Unordered, BoolRLE,
+};
+
+// ["key",value,...]形式的容器
+bool isPairList(Role role) {
+    switch (role) {
+    case Role::Root: case Role::Topology: case Role::PointRef: case Role::Attributes:
+    case Role::AttributeMeta: case Role::AttributeData: case Role::AttributeValues:
+    case Role::RunType: case Role::RunAttribs:
+    case Role::GroupMeta: case Role::GroupData: case Role::Selection: case Role::Unordered:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 由nlohmann的SAX事件驱动，按路径识别P、pointref、primitives和组，攒满一块就回调
+class StreamHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    StreamHandler(const GeoStreamCallbacks& callbacks, size_t chunkSize)
+        : callbacks(callbacks), chunkSize(std::max<size_t>(chunkSize, 1)) {}
+
+    bool null() override { return scalar(); }
+    bool boolean(bool val) override {
+        if (!stack.empty() && stack.back().role == Role::BoolRLE && stack.back().index % 2 == 1) {
+            emitGroupRun(val);
+        }
+        return scalar();
+    }
+    bool number_integer(number_integer_t val) override { return number(static_cast<double>(val)); }
+    bool number_unsigned(number_unsigned_t val) override { return number(static_cast<double>(val)); }
+    bool number_float(number_float_t val, const string_t&) override { return number(val); }
+    bool binary(binary_t&) override { return scalar(); }
+
+    bool string(string_t& val) override {
+        if (stack.empty()) return true;
+        Frame& parent = stack.back();
+        if (isPairList(parent.role) && parent.index % 2 == 0) {
+            parent.key = val;
+        }
+        else {
+            const std::string& key = parent.key;
+            if (parent.role == Role::AttributeMeta && key == "name") attrName = val;
+            else if (parent.role == Role::RunType && key == "type") runType = val;
+            else if (parent.role == Role::GroupMeta && key == "name") groupName = val;
+            else if (parent.role == Role::Info && key == "primcount_summary") primcountSummary = val;
+        }
+        return scalar();
+    }
+
+    bool start_object(std::size_t) override {
+        Role role = childRole();
+        if (role != Role::Info) role = Role::Other;
+        stack.push_back(Frame{role, 0, std::string()});
+        return true;
+    }
+    bool key(string_t& val) override {
+        stack.back().key = val;
+        return true;
+    }
+    bool end_object() override { return endContainer(); }
+
+    bool start_array(std::size_t) override {
+        const Role role = stack.empty() ? Role::Root : childRole();
+        switch (role) {
+        case Role::Indices: beginIndices(); break;
+        case Role::Attribute: attrName.clear(); tupleSize = 1; break;
+        case Role::Tuples: case Role::Arrays: attrPoint = 0; attrValues.clear(); break;
+        case Role::Run: runType.clear(); runStartVertex = 0; runCount = 0; break;
+        case Role::Groups: pointGroups = stack.back().key == "pointgroups"; break;
+        case Role::Group: groupName.clear(); groupPos = 0; break;
+        default: break;
+        }
+        stack.push_back(Frame{role, 0, std::string()});
+        return true;
+    }
+    bool end_array() override {
+        switch (stack.back().role) {
+        case Role::Root: sendHeader(); break;
+        case Role::Indices: flushIndices(); break;
+        case Role::Tuples: case Role::Arrays: flushAttribute(); break;
+        case Role::Run:
+            if (callbacks.primitiveRun) callbacks.primitiveRun(runType, runFirst, runCount, runStartVertex);
+            runFirst += runCount;
+            break;
+        default: break;
+        }
+        return endContainer();
+    }
+
+    bool parse_error(std::size_t position, const std::string& lastToken, const nlohmann::detail::exception& ex) override {
+        // 出错的记号可能是很长的字符串，只保留开头
+        const std::string token = lastToken.size() > 64 ? lastToken.substr(0, 64) + "..." : lastToken;
+        throw std::runtime_error("JSON parsing error at byte " + std::to_string(position) + " near '" + token + "': " + ex.what());
+    }
+
+private:
+    struct Frame {
+        Role role;
+        size_t index = 0;
+        std::string key;
+    };
+
+    // 当前父容器中下一个值的角色
+    Role childRole() const {
+        const Frame& parent = stack.back();
+        if (isPairList(parent.role) && parent.index % 2 == 0) {
+            return Role::Other;  // 键的位置
+        }
+        const std::string& key = parent.key;
+        switch (parent.role) {
+        case Role::Root:
+            if (key == "topology") return Role::Topology;
+            if (key == "attributes") return Role::Attributes;
+            if (key == "primitives") return Role::Primitives;
+            if (key == "pointgroups" || key == "primitivegroups") return Role::Groups;
+            if (key == "info") return Role::Info;
+            return Role::Other;
+        case Role::Topology: return key == "pointref" ? Role::PointRef : Role::Other;
+        case Role::PointRef: return key == "indices" ? Role::Indices : Role::Other;
+        case Role::Attributes: return key == "pointattributes" ? Role::PointAttributes : Role::Other;
+        case Role::PointAttributes: return Role::Attribute;
+        case Role::Attribute: return parent.index == 0 ? Role::AttributeMeta : (parent.index == 1 ? Role::AttributeData : Role::Other);
+        case Role::AttributeData: return key == "values" ? Role::AttributeValues : Role::Other;
+        case Role::AttributeValues:
+            if (key == "tuples") return Role::Tuples;
+            if (key == "arrays") return Role::Arrays;
+            return Role::Other;
+        case Role::Tuples: return Role::Tuple;
+        case Role::Arrays: return Role::ArrayValues;
+        case Role::Primitives: return Role::Run;
+        case Role::Run: return parent.index == 0 ? Role::RunType : (parent.index == 1 ? Role::RunAttribs : Role::Other);
+        case Role::Groups: return Role::Group;
+        case Role::Group: return parent.index == 0 ? Role::GroupMeta : (parent.index == 1 ? Role::GroupData : Role::Other);
+        case Role::GroupData: return key == "selection" ? Role::Selection : Role::Other;
+        case Role::Selection: return key == "unordered" ? Role::Unordered : Role::Other;
+        case Role::Unordered: return key == "boolRLE" ? Role::BoolRLE : Role::Other;
+        default: return Role::Other;
+        }
+    }
+
+    bool endContainer() {
+        stack.pop_back();
+        return scalar();
+    }
+
+    // 一个值结束，父容器计数加一
+    bool scalar() {
+        if (!stack.empty()) {
+            stack.back().index++;
+        }
+        return true;
+    }
+
+    bool number(double val) {
+        if (stack.empty()) return true;
+        Frame& parent = stack.back();
+        const std::string& key = parent.key;
+        switch (parent.role) {
+        case Role::Root:
+            if (key == "pointcount") header.pointCount = static_cast<size_t>(val);
+            else if (key == "vertexcount") header.vertexCount = static_cast<size_t>(val);
+            else if (key == "primitivecount") header.primitiveCount = static_cast<size_t>(val);
+            break;
+        case Role::Indices:
+            pushIndex(static_cast<int>(val));
+            break;
+        case Role::AttributeData: case Role::AttributeValues:
+            if (key == "size" && parent.index % 2 == 1) tupleSize = std::max(1, static_cast<int>(val));
+            break;
+        case Role::Tuple:
+            pushAttributeValue(val);
+            break;
+        case Role::ArrayValues:
+            // "arrays"只在每点一个分量时与点顺序一致
+            if (tupleSize == 1) pushAttributeValue(val);
+            break;
+        case Role::RunAttribs:
+            if (key == "startvertex") runStartVertex = static_cast<size_t>(val);
+            else if (key == "nprimitives") runCount = static_cast<size_t>(val);
+            break;
+        case Role::BoolRLE:
+            if (parent.index % 2 == 0) groupRunLength = static_cast<size_t>(val);
+            else emitGroupRun(val != 0);
+            break;
+        default:
+            break;
+        }
+        return scalar();
+    }
+
+    void sendHeader() {
+        if (!headerSent) {
+            headerSent = true;
+            if (callbacks.header) callbacks.header(header);
+        }
+    }
+
+    // 读到pointref之前确定图元布局：(每图元顶点数, 图元数)的序列
+    void beginIndices() {
+        sendHeader();
+        layout.clear();
+        const size_t prims = header.primitiveCount;
+        if (prims > 0 && header.vertexCount == prims * 4) {
+            layout.emplace_back(4, prims);
+        }
+        else if (prims > 0 && header.vertexCount == prims * 3) {
+            layout.emplace_back(3, prims);
+        }
+        else if (!primcountSummary.empty()) {
+            int tets = 0, polygons = 0;
+            HoudiniGeoIO::parsePrimcountSummary(primcountSummary, tets, polygons);
+            if (static_cast<size_t>(tets + polygons) == prims &&
+                static_cast<size_t>(tets) * 4 + static_cast<size_t>(polygons) * 3 == header.vertexCount) {
+                if (tets > 0) layout.emplace_back(4, tets);
+                if (polygons > 0) layout.emplace_back(3, polygons);
+            }
+        }
+        segment = 0;
+        segmentLeft = layout.empty() ? 0 : layout[0].second;
+        firstVertex = 0;
+        firstPrimitive = 0;
+        indexBuffer.clear();
+    }
+
+    void pushIndex(int point) {
+        if (!callbacks.vertices && !callbacks.primitives) return;
+        indexBuffer.push_back(point);
+        if (!layout.empty() && segment < layout.size()) {
+            const size_t vpp = layout[segment].first;
+            const size_t prims = indexBuffer.size() / vpp;
+            if (indexBuffer.size() % vpp == 0 && (prims == chunkSize || prims == segmentLeft)) {
+                flushIndices();
+            }
+        }
+        else if (indexBuffer.size() == chunkSize) {
+            flushIndices();
+        }
+    }
+
+    void flushIndices() {
+        if (indexBuffer.empty()) return;
+        const size_t n = indexBuffer.size();
+        if (callbacks.vertices) callbacks.vertices(firstVertex, indexBuffer.data(), n);
+        if (!layout.empty() && segment < layout.size()) {
+            const size_t vpp = layout[segment].first;
+            const size_t prims = n / vpp;
+            if (callbacks.primitives) {
+                callbacks.primitives(firstPrimitive, static_cast<int>(vpp), indexBuffer.data(), prims);
+            }
+            firstPrimitive += prims;
+            segmentLeft -= prims;
+            if (segmentLeft == 0 && ++segment < layout.size()) {
+                segmentLeft = layout[segment].second;
+            }
+        }
+        firstVertex += n;
+        indexBuffer.clear();
+    }
+
+    void pushAttributeValue(double val) {
+        if (!callbacks.pointAttribute) return;
+        attrValues.push_back(val);
+        if (attrValues.size() == chunkSize * tupleSize) {
+            flushAttribute();
+        }
+    }
+
+    void flushAttribute() {
+        if (attrValues.empty()) return;
+        const size_t count = attrValues.size() / tupleSize;
+        callbacks.pointAttribute(attrName, tupleSize, attrPoint, attrValues.data(), count);
+        attrPoint += count;
+        attrValues.clear();
+    }
+
+    void emitGroupRun(bool value) {
+        if (callbacks.groupRun && groupRunLength > 0) {
+            callbacks.groupRun(groupName, pointGroups, groupPos, groupRunLength, value);
+        }
+        groupPos += groupRunLength;
+    }
+
+    const GeoStreamCallbacks& callbacks;
+    const size_t chunkSize;
+    std::vector<Frame> stack;
+
+    GeoStreamHeader header;
+    bool headerSent = false;
+    std::string primcountSummary;
+
+    // pointref
+    std::vector<std::pair<size_t, size_t>> layout;
+    size_t segment = 0;
+    size_t segmentLeft = 0;
+    size_t firstVertex = 0;
+    size_t firstPrimitive = 0;
+    std::vector<int> indexBuffer;
+
+    // 点属性
+    std::string attrName;
+    int tupleSize = 1;
+    size_t attrPoint = 0;
+    std::vector<double> attrValues;
+
+    // primitives
+    std::string runType;
+    size_t runFirst = 0;
+    size_t runStartVertex = 0;
+    size_t runCount = 0;
+
+    // 组
+    bool pointGroups = true;
+    std::string groupName;
+    size_t groupPos = 0;
+    size_t groupRunLength = 0;
+};
+
+}
+
+HoudiniGeoStreamReader::HoudiniGeoStreamReader(GeoStreamCallbacks callbacks, Options options)
+    : callbacks(std::move(callbacks)), options(options) {
+}
+
+void HoudiniGeoStreamReader::read(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filePath);
+    }
+
+    try {
+        StreamHandler handler(callbacks, options.chunkSize);
+        const GeoFileFormat format = HoudiniGeoIO::formatFromPath(filePath);
+        if (format == GeoFileFormat::Ascii) {
+            nlohmann::json::sax_parse(file, &handler);
+        }
+        else if (format == GeoFileFormat::AsciiGzip) {
+            HoudiniGeoGzip::InputStreambuf gzbuf(file);
+            std::istream gzstream(&gzbuf);
+            nlohmann::json::sax_parse(gzstream, &handler);
+        }
+        else {
+            // 二进制格式先解码成DOM，再以文本形式走同样的事件流
+            std::string bytes;
+            if (format == GeoFileFormat::BinaryGzip) {
+                bytes = HoudiniGeoGzip::decompress(file);
+            }
+            else {
+                bytes.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            }
+            if (!HoudiniGeoBinary::hasMagic(bytes.data(), bytes.size())) {
+                throw std::runtime_error("Not a binary geo file");
+            }
+            const std::string text = HoudiniGeoBinary::decode(bytes.data(), bytes.size()).dump();
+            bytes.clear();
+            bytes.shrink_to_fit();
+            nlohmann::json::sax_parse(text, &handler);
+        }
+        std::cout << "Finish streaming geo file: " << filePath << std::endl;
+    }
+    catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("JSON parsing error: " + std::string(e.what()) +
+                               "\nFile: " + filePath);
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("Error reading file: " + std::string(e.what()) +
+                               "\nFile: " + filePath);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <functional>
+#include <string>
+
+
+struct GeoStreamHeader {
+    size_t pointCount = 0;
+    size_t vertexCount = 0;
+    size_t primitiveCount = 0;
+};
+
+// 流式读取的回调，不需要的留空。指针只在回调期间有效。
+struct GeoStreamCallbacks {
+    // 在topology之前调用一次
+    std::function<void(const GeoStreamHeader& header)> header;
+    // 数值点属性（包括P）的一段连续点，values为count*tupleSize个分量
+    std::function<void(const std::string& name, int tupleSize, size_t firstPoint, const double* values, size_t count)> pointAttribute;
+    // 一段连续顶点对应的点索引
+    std::function<void(size_t firstVertex, const int* points, size_t count)> vertices;
+    // 一段同类图元的点索引，每个图元verticesPerPrimitive个。
+    // 只有在读到topology之前能确定图元布局时才会调用：全部四面体/全部三角形，
+    // 或者info.primcount_summary给出了四面体和三角形的数量（四面体在前，与readTetWithSurface()相同的约定）。
+    std::function<void(size_t firstPrimitive, int verticesPerPrimitive, const int* points, size_t count)> primitives;
+    // primitives段中的一个run，例如 ("Tetrahedron_run", 0, 20044, 0)
+    std::function<void(const std::string& type, size_t firstPrimitive, size_t count, size_t startVertex)> primitiveRun;
+    // 点组/图元组boolRLE中的一段
+    std::function<void(const std::string& group, bool pointGroup, size_t first, size_t count, bool value)> groupRun;
+};
+
+struct GeoStreamOptions {
+    // 每次回调最多的点数/图元数。能确定图元布局时顶点按整图元分块，一块最多chunkSize个图元的顶点，
+    // 否则最多chunkSize个顶点。
+    size_t chunkSize = 65536;
+};
+
+// 边解析边回调，不建DOM，也不保留整个网格。
+// .geo和.geo.gz逐字节流式解析，内存只与chunkSize有关；
+// .bgeo/.bgeo.gz需要先整体解码，内存与文件大小相关。
+class HoudiniGeoStreamReader {
+public:
+    using Options = GeoStreamOptions;
+
+    explicit HoudiniGeoStreamReader(GeoStreamCallbacks callbacks, Options options = Options());
+
+    void read(const std::string& filePath);
+
+private:
+    GeoStreamCallbacks callbacks;
+    Options options;
+};
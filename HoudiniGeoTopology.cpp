@@ -0,0 +1,863 @@
+#include "HoudiniGeoTopology.h"
+#include "HoudiniGeoParallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace {
+
+// 四面体的第f个面，与第f个顶点相对
+const int tetFaces[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+const size_t grainSize = 16384;
+
+// 并行计数排序。emit(source, push)为每个源元素调用push(bucket, items, n)，把n个元素放进同一个桶；
+// 得到CSR形式的offsets（bucketCount+1个）和items。emit会被调用两遍（计数、写入），结果需要一致。
+// sortBuckets时桶内按元素升序，结果与线程数无关；否则桶内顺序不确定。
+template<class EmitFn>
+void bucketSort(size_t sourceCount, size_t bucketCount, EmitFn emit, std::vector<int>& offsets, std::vector<int>& items,
+                bool sortBuckets) {
+    std::vector<std::atomic<int>> cursor(bucketCount);
+    HoudiniGeoParallelFor(0, sourceCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            emit(i, [&](int bucket, const int*, int n) { cursor[bucket].fetch_add(n, std::memory_order_relaxed); });
+        }
+    });
+
+    offsets.resize(bucketCount + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < bucketCount; i++) {
+        offsets[i + 1] = offsets[i] + cursor[i].load(std::memory_order_relaxed);
+        cursor[i].store(offsets[i], std::memory_order_relaxed);  // 之后作为写入游标
+    }
+
+    items.resize(offsets[bucketCount]);
+    int* out = items.data();
+    HoudiniGeoParallelFor(0, sourceCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            emit(i, [&](int bucket, const int* values, int n) {
+                std::copy(values, values + n, out + cursor[bucket].fetch_add(n, std::memory_order_relaxed));
+            });
+        }
+    });
+    if (sortBuckets) {
+        HoudiniGeoParallelFor(0, bucketCount, grainSize, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) {
+                std::sort(items.begin() + offsets[i], items.begin() + offsets[i + 1]);
+            }
+        });
+    }
+}
+
+// 并行LSD基数排序（稳定），只排keys的低bits位。values不为空时随键一起移动。
+// 每轮11位，按块统计直方图后各块独立写入自己的区间；所有键这一位都相同时跳过这一轮。
+void radixSort(std::vector<uint64_t>& keys, std::vector<int>* values, int bits) {
+    const int digitBits = 11;
+    const size_t radix = size_t(1) << digitBits;
+    const size_t n = keys.size();
+    const size_t numChunks = std::max<size_t>(1, std::min<size_t>(256, n / grainSize));
+    const size_t chunk = (n + numChunks - 1) / numChunks;
+
+    std::vector<uint64_t> keysOut(n);
+    std::vector<int> valuesOut(values ? n : 0);
+    std::vector<size_t> histogram(numChunks * radix);
+    for (int shift = 0; shift < bits; shift += digitBits) {
+        HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+            for (size_t c = b; c < e; c++) {
+                size_t* h = histogram.data() + c * radix;
+                std::fill(h, h + radix, 0);
+                for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); i++) {
+                    h[(keys[i] >> shift) & (radix - 1)]++;
+                }
+            }
+        });
+
+        // 按(位值, 块)的顺序做前缀和，得到每块每个位值的起始位置
+        size_t sum = 0;
+        bool trivial = false;
+        for (size_t d = 0; d < radix; d++) {
+            size_t digitTotal = 0;
+            for (size_t c = 0; c < numChunks; c++) {
+                const size_t count = histogram[c * radix + d];
+                histogram[c * radix + d] = sum;
+                sum += count;
+                digitTotal += count;
+            }
+            if (digitTotal == n) trivial = true;
+        }
+        if (trivial) continue;
+
+        HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+            for (size_t c = b; c < e; c++) {
+                size_t* pos = histogram.data() + c * radix;
+                for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); i++) {
+                    const size_t dst = pos[(keys[i] >> shift) & (radix - 1)]++;
+                    keysOut[dst] = keys[i];
+                    if (values) valuesOut[dst] = (*values)[i];
+                }
+            }
+        });
+        keys.swap(keysOut);
+        if (values) values->swap(valuesOut);
+    }
+}
+
+// 把21位整数的各位分散到每3位中的最低位
+uint64_t spreadBits(uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffull;
+    x = (x | x << 16) & 0x1f0000ff0000ffull;
+    x = (x | x << 8) & 0x100f00f00f00f00full;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2) & 0x1249249249249249ull;
+    return x;
+}
+
+uint64_t mortonCode(uint32_t x, uint32_t y, uint32_t z) {
+    return (spreadBits(x) << 2) | (spreadBits(y) << 1) | spreadBits(z);
+}
+
+// Skilling的转置Hilbert变换（AIP Conf. Proc. 707, 2004），变换后按Morton的方式交错即为Hilbert编码
+uint64_t hilbertCode(uint32_t x, uint32_t y, uint32_t z, int bits) {
+    uint32_t X[3] = {x, y, z};
+    const uint32_t M = 1u << (bits - 1);
+    for (uint32_t Q = M; Q > 1; Q >>= 1) {
+        const uint32_t P = Q - 1;
+        for (int i = 0; i < 3; i++) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            }
+            else {
+                const uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for (uint32_t Q = M; Q > 1; Q >>= 1) {
+        if (X[2] & Q) t ^= Q - 1;
+    }
+    return mortonCode(X[0] ^ t, X[1] ^ t, X[2] ^ t);
+}
+
+// 按曲线编码排序[0, count)，center(i, xyz)给出第i个元素的位置；得到order和rank
+template<class CenterFn>
+void sortByCurve(size_t count, const double lower[3], double scale, GeoSpaceFillingCurve curve, CenterFn center,
+                 std::vector<int>& order, std::vector<int>& rank) {
+    const int bits = 21;
+    const double maxCell = double((1u << bits) - 1);
+    std::vector<uint64_t> codes(count);
+    order.resize(count);
+    HoudiniGeoParallelFor(0, count, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            double c[3];
+            center(i, c);
+            uint32_t q[3];
+            for (int axis = 0; axis < 3; axis++) {
+                const double cell = (c[axis] - lower[axis]) * scale;
+                q[axis] = static_cast<uint32_t>(cell > 0 ? std::min(cell, maxCell) : 0.0);
+            }
+            codes[i] = curve == GeoSpaceFillingCurve::Hilbert ? hilbertCode(q[0], q[1], q[2], bits) : mortonCode(q[0], q[1], q[2]);
+            order[i] = static_cast<int>(i);
+        }
+    });
+    radixSort(codes, &order, 3 * bits);
+    rank.resize(count);
+    HoudiniGeoParallelFor(0, count, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) rank[order[i]] = static_cast<int>(i);
+    });
+}
+
+void checkTetIndices(const std::vector<int>& tetIndices, size_t pointCount) {
+    if (tetIndices.size() % 4 != 0) {
+        throw std::runtime_error("Tet indices size is not a multiple of 4");
+    }
+    if (tetIndices.size() > size_t(INT32_MAX)) {
+        throw std::runtime_error("Too many tets");
+    }
+    for (int v : tetIndices) {
+        if (v < 0 || size_t(v) >= pointCount) {
+            throw std::runtime_error("Tet index out of range: " + std::to_string(v));
+        }
+    }
+}
+
+void checkTriangleIndices(const std::vector<int>& triangles, size_t pointCount) {
+    if (triangles.size() % 3 != 0) {
+        throw std::runtime_error("Triangle indices size is not a multiple of 3");
+    }
+    for (int v : triangles) {
+        if (v < 0 || size_t(v) >= pointCount) {
+            throw std::runtime_error("Triangle index out of range: " + std::to_string(v));
+        }
+    }
+}
+
+// 第face个面（编号为四面体*4+相对顶点）的第k个顶点
+int faceCorner(const int* tets, size_t face, int k) {
+    return tets[(face & ~size_t(3)) + tetFaces[face & 3][k]];
+}
+
+// 为每个面找到另一侧与它重合的面：mate[face]为配对的面编号，边界面为-1，被两个以上四面体共用的面为-2
+void matchFaces(const int* tets, size_t faceCount, size_t pointCount, std::vector<int>& mate) {
+    auto corner = [&](size_t face, int k) { return faceCorner(tets, face, k); };
+
+    // 按最小顶点分桶，桶内用另外两个顶点组成的64位键排序，键相同的面互相配对。
+    // 四个顶点排序后，最小的顶点是三个面的最小顶点，第二小的是剩下那个面（与最小顶点相对）的最小顶点。
+    std::vector<int> offsets, faces;
+    bucketSort(faceCount / 4, pointCount, [&](size_t t, auto&& push) {
+        int order[4] = {0, 1, 2, 3};
+        const int* tet = tets + t * 4;
+        std::sort(order, order + 4, [&](int i, int j) { return tet[i] < tet[j]; });
+        const int base = static_cast<int>(t * 4);
+        const int withMin[3] = {base + order[1], base + order[2], base + order[3]};
+        const int opposite = base + order[0];
+        push(tet[order[0]], withMin, 3);
+        push(tet[order[1]], &opposite, 1);
+    }, offsets, faces, false);
+
+    mate.assign(faceCount, -1);
+    HoudiniGeoParallelFor(0, pointCount, grainSize, [&](size_t b, size_t e) {
+        std::vector<std::pair<uint64_t, int>> keys;
+        for (size_t v = b; v < e; v++) {
+            keys.clear();
+            for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+                const int f = faces[i];
+                int a = corner(f, 0), c = corner(f, 1), d = corner(f, 2);
+                int lo = int(v) == a ? std::min(c, d) : int(v) == c ? std::min(a, d) : std::min(a, c);
+                int hi = static_cast<int>(int64_t(a) + c + d - int64_t(v) - lo);
+                keys.emplace_back((uint64_t(uint32_t(lo)) << 32) | uint32_t(hi), f);
+            }
+            std::sort(keys.begin(), keys.end());  // 相同的键按面编号排列，结果与分桶时的顺序无关
+            for (size_t i = 0; i < keys.size();) {
+                size_t j = i + 1;
+                while (j < keys.size() && keys[j].first == keys[i].first) j++;
+                if (j - i == 2) {
+                    mate[keys[i].second] = keys[i + 1].second;
+                    mate[keys[i + 1].second] = keys[i].second;
+                }
+                else if (j - i > 2) {
+                    for (size_t k = i; k < j; k++) mate[keys[k].second] = -2;
+                }
+                i = j;
+            }
+        }
+    });
+}
+
+// 不重复的边，edges每2个一条，小编号在前，按(小编号, 大编号)升序
+void collectEdges(const std::vector<int>& tetIndices, const std::vector<int>& triangles, size_t pointCount,
+                  std::vector<int>& edges) {
+    // 边(a, b)，a < b，编码为a * 点数 + b，排序只需要log2(点数^2)位
+    const uint64_t n = pointCount;
+    auto edgeKey = [n](int a, int b) { return a < b ? uint64_t(a) * n + b : uint64_t(b) * n + a; };
+    const size_t tetCount = tetIndices.size() / 4;
+    const size_t triCount = triangles.size() / 3;
+    std::vector<uint64_t> keys(tetCount * 6 + triCount * 3);
+    HoudiniGeoParallelFor(0, tetCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t t = b; t < e; t++) {
+            const int* v = tetIndices.data() + t * 4;
+            uint64_t* k = keys.data() + t * 6;
+            k[0] = edgeKey(v[0], v[1]);
+            k[1] = edgeKey(v[0], v[2]);
+            k[2] = edgeKey(v[0], v[3]);
+            k[3] = edgeKey(v[1], v[2]);
+            k[4] = edgeKey(v[1], v[3]);
+            k[5] = edgeKey(v[2], v[3]);
+        }
+    });
+    HoudiniGeoParallelFor(0, triCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t t = b; t < e; t++) {
+            const int* v = triangles.data() + t * 3;
+            uint64_t* k = keys.data() + tetCount * 6 + t * 3;
+            k[0] = edgeKey(v[0], v[1]);
+            k[1] = edgeKey(v[1], v[2]);
+            k[2] = edgeKey(v[2], v[0]);
+        }
+    });
+
+    int bits = 1;
+    while (bits < 64 && (uint64_t(1) << bits) < n * n) bits++;
+    radixSort(keys, nullptr, bits);
+
+    // 去掉相邻的重复键和退化四面体产生的自环：先统计每块保留的键数，再并行写入
+    const size_t numChunks = (keys.size() + grainSize - 1) / grainSize;
+    std::vector<size_t> chunkStart(numChunks + 1, 0);
+    auto isFirst = [&](size_t i) {
+        return (i == 0 || keys[i] != keys[i - 1]) && keys[i] / n != keys[i] % n;
+    };
+    HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; c++) {
+            size_t count = 0;
+            for (size_t i = c * grainSize; i < std::min(keys.size(), (c + 1) * grainSize); i++) count += isFirst(i);
+            chunkStart[c + 1] = count;
+        }
+    });
+    for (size_t c = 0; c < numChunks; c++) chunkStart[c + 1] += chunkStart[c];
+
+    edges.resize(chunkStart[numChunks] * 2);
+    HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; c++) {
+            size_t out = chunkStart[c];
+            for (size_t i = c * grainSize; i < std::min(keys.size(), (c + 1) * grainSize); i++) {
+                if (!isFirst(i)) continue;
+                edges[out * 2] = static_cast<int>(keys[i] / n);
+                edges[out * 2 + 1] = static_cast<int>(keys[i] % n);
+                out++;
+            }
+        }
+    });
+}
+
+
+// 从start出发按层遍历所在的连通分量（只走mark[v] != stamp的点并把它们标记为stamp），
+// 返回层数，last为最后一层中度数最小的点
+int breadthFirstDepth(const GeoCSR& graph, int start, std::vector<int>& mark, int stamp, std::vector<int>& queue, int& last) {
+    queue.clear();
+    queue.push_back(start);
+    mark[start] = stamp;
+    int depth = 0;
+    size_t levelBegin = 0;
+    while (levelBegin < queue.size()) {
+        const size_t levelEnd = queue.size();
+        last = queue[levelBegin];
+        for (size_t i = levelBegin; i < levelEnd; i++) {
+            const int u = queue[i];
+            if (graph.count(u) < graph.count(last)) last = u;
+            for (const int* v = graph.begin(u); v != graph.end(u); ++v) {
+                if (mark[*v] != stamp) {
+                    mark[*v] = stamp;
+                    queue.push_back(*v);
+                }
+            }
+        }
+        levelBegin = levelEnd;
+        depth++;
+    }
+    return depth;
+}
+
+size_t graphBandwidth(const GeoCSR& graph, const std::vector<int>* rank) {
+    size_t bandwidth = 0;
+    for (size_t u = 0; u < graph.rows(); u++) {
+        const long long ru = rank ? (*rank)[u] : static_cast<long long>(u);
+        for (const int* v = graph.begin(u); v != graph.end(u); ++v) {
+            const long long rv = rank ? (*rank)[*v] : *v;
+            bandwidth = std::max<size_t>(bandwidth, static_cast<size_t>(ru > rv ? ru - rv : rv - ru));
+        }
+    }
+    return bandwidth;
+}
+
+}
+
+void HoudiniGeoExtractBoundary(const std::vector<int>& tetIndices, const std::vector<double>& positions,
+                               std::vector<int>& triangles, std::vector<bool>* isSurfacePoint) {
+    const size_t pointCount = positions.size() / 3;
+    checkTetIndices(tetIndices, pointCount);
+    const size_t faceCount = tetIndices.size();  // 每个四面体4个面
+    const int* tets = tetIndices.data();
+
+    auto corner = [&](size_t face, int k) { return faceCorner(tets, face, k); };
+
+    std::vector<int> mate;
+    matchFaces(tets, faceCount, pointCount, mate);
+
+    // 按面的编号（即四面体顺序）输出，先统计每块的边界面数再并行写入
+    const size_t numChunks = (faceCount + grainSize - 1) / grainSize;
+    std::vector<size_t> chunkStart(numChunks + 1, 0);
+    HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; c++) {
+            size_t n = 0;
+            for (size_t f = c * grainSize; f < std::min(faceCount, (c + 1) * grainSize); f++) n += mate[f] == -1;
+            chunkStart[c + 1] = n;
+        }
+    });
+    for (size_t c = 0; c < numChunks; c++) chunkStart[c + 1] += chunkStart[c];
+
+    triangles.resize(chunkStart[numChunks] * 3);
+    const double* p = positions.data();
+    HoudiniGeoParallelFor(0, numChunks, 1, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; c++) {
+            int* out = triangles.data() + chunkStart[c] * 3;
+            for (size_t f = c * grainSize; f < std::min(faceCount, (c + 1) * grainSize); f++) {
+                if (mate[f] != -1) continue;
+                int a = corner(f, 0), u = corner(f, 1), w = corner(f, 2);
+                const int opposite = tets[f];
+                // Houdini的绕序：(u-a)x(w-a)指向四面体内部（相对的顶点一侧）
+                const double e1[3] = {p[u * 3] - p[a * 3], p[u * 3 + 1] - p[a * 3 + 1], p[u * 3 + 2] - p[a * 3 + 2]};
+                const double e2[3] = {p[w * 3] - p[a * 3], p[w * 3 + 1] - p[a * 3 + 1], p[w * 3 + 2] - p[a * 3 + 2]};
+                const double e3[3] = {p[opposite * 3] - p[a * 3], p[opposite * 3 + 1] - p[a * 3 + 1], p[opposite * 3 + 2] - p[a * 3 + 2]};
+                const double side = (e1[1] * e2[2] - e1[2] * e2[1]) * e3[0] +
+                                    (e1[2] * e2[0] - e1[0] * e2[2]) * e3[1] +
+                                    (e1[0] * e2[1] - e1[1] * e2[0]) * e3[2];
+                if (side < 0) std::swap(u, w);
+                *out++ = a;
+                *out++ = u;
+                *out++ = w;
+            }
+        }
+    });
+
+    if (isSurfacePoint) {
+        std::vector<uint8_t> marks(pointCount, 0);
+        for (int v : triangles) marks[v] = 1;
+        isSurfacePoint->assign(pointCount, false);
+        for (size_t i = 0; i < pointCount; i++) {
+            if (marks[i]) (*isSurfacePoint)[i] = true;
+        }
+    }
+}
+
+void HoudiniGeoBuildTetAdjacency(const std::vector<int>& tetIndices, size_t pointCount, GeoTetAdjacency& out) {
+    checkTetIndices(tetIndices, pointCount);
+    const size_t tetCount = tetIndices.size() / 4;
+    const int* tets = tetIndices.data();
+
+    std::vector<int>& mate = out.faceNeighbors;
+    matchFaces(tets, tetIndices.size(), pointCount, mate);
+    HoudiniGeoParallelFor(0, mate.size(), grainSize, [&](size_t b, size_t e) {
+        for (size_t f = b; f < e; f++) {
+            mate[f] = mate[f] >= 0 ? mate[f] / 4 : -1;  // 配对的面编号换成所在的四面体
+        }
+    });
+
+    bucketSort(tetCount, pointCount, [&](size_t t, auto&& push) {
+        const int tet = static_cast<int>(t);
+        for (int k = 0; k < 4; k++) {
+            push(tets[t * 4 + k], &tet, 1);
+        }
+    }, out.pointTets.offsets, out.pointTets.items, true);
+}
+
+void HoudiniGeoExtractEdges(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                            const std::vector<double>& positions, std::vector<int>& edges,
+                            std::vector<double>* restLengths) {
+    const size_t pointCount = positions.size() / 3;
+    checkTetIndices(tetIndices, pointCount);
+    checkTriangleIndices(triangles, pointCount);
+    collectEdges(tetIndices, triangles, pointCount, edges);
+    if (!restLengths) {
+        return;
+    }
+
+    const size_t edgeCount = edges.size() / 2;
+    restLengths->resize(edgeCount);
+    const double* p = positions.data();
+    HoudiniGeoParallelFor(0, edgeCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            const int u = edges[i * 2], v = edges[i * 2 + 1];
+            const double dx = p[v * 3] - p[u * 3];
+            const double dy = p[v * 3 + 1] - p[u * 3 + 1];
+            const double dz = p[v * 3 + 2] - p[u * 3 + 2];
+            (*restLengths)[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    });
+}
+
+GeoReordering HoudiniGeoSpatialOrder(const std::vector<double>& positions, const std::vector<int>& tetIndices,
+                                     const std::vector<int>& triangles, GeoSpaceFillingCurve curve) {
+    const size_t pointCount = positions.size() / 3;
+    checkTetIndices(tetIndices, pointCount);
+    checkTriangleIndices(triangles, pointCount);
+
+    // 所有轴用同一个缩放，保持形状
+    double lower[3] = {0, 0, 0}, upper[3] = {0, 0, 0};
+    for (size_t i = 0; i < pointCount; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            const double x = positions[i * 3 + axis];
+            if (i == 0 || x < lower[axis]) lower[axis] = x;
+            if (i == 0 || x > upper[axis]) upper[axis] = x;
+        }
+    }
+    const double extent = std::max({upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2]});
+    const double scale = extent > 0 ? double((1u << 21) - 1) / extent : 0.0;
+
+    const double* p = positions.data();
+    GeoReordering r;
+    sortByCurve(pointCount, lower, scale, curve, [&](size_t i, double c[3]) {
+        c[0] = p[i * 3];
+        c[1] = p[i * 3 + 1];
+        c[2] = p[i * 3 + 2];
+    }, r.pointOrder, r.pointRank);
+
+    auto centroids = [&](const std::vector<int>& prims, int n, std::vector<int>& order, std::vector<int>& rank) {
+        sortByCurve(prims.size() / n, lower, scale, curve, [&](size_t i, double c[3]) {
+            c[0] = c[1] = c[2] = 0;
+            for (int k = 0; k < n; k++) {
+                const double* q = p + size_t(prims[i * n + k]) * 3;
+                c[0] += q[0];
+                c[1] += q[1];
+                c[2] += q[2];
+            }
+            c[0] /= n;
+            c[1] /= n;
+            c[2] /= n;
+        }, order, rank);
+    };
+    centroids(tetIndices, 4, r.tetOrder, r.tetRank);
+    centroids(triangles, 3, r.triangleOrder, r.triangleRank);
+    return r;
+}
+
+void HoudiniGeoRemapPrimitives(std::vector<int>& indices, int verticesPerPrimitive,
+                               const std::vector<int>& primitiveOrder, const std::vector<int>& pointRank) {
+    HoudiniGeoPermute(indices, primitiveOrder, verticesPerPrimitive);
+    if (pointRank.empty()) {
+        return;
+    }
+    HoudiniGeoParallelFor(0, indices.size(), grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) indices[i] = pointRank[indices[i]];
+    });
+}
+
+void HoudiniGeoPointAdjacency(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                              size_t pointCount, GeoCSR& out) {
+    checkTetIndices(tetIndices, pointCount);
+    checkTriangleIndices(triangles, pointCount);
+    std::vector<int> edges;
+    collectEdges(tetIndices, triangles, pointCount, edges);
+    bucketSort(edges.size() / 2, pointCount, [&](size_t i, auto&& push) {
+        push(edges[i * 2], &edges[i * 2 + 1], 1);
+        push(edges[i * 2 + 1], &edges[i * 2], 1);
+    }, out.offsets, out.items, true);
+}
+
+GeoReordering HoudiniGeoRCMOrder(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                                 size_t pointCount, GeoBandwidth* bandwidth) {
+    GeoCSR graph;
+    HoudiniGeoPointAdjacency(tetIndices, triangles, pointCount, graph);
+    const int n = static_cast<int>(pointCount);
+
+    // 按度数计数排序，依次取未访问的度数最小的点作为各连通分量的起点
+    int maxDegree = 0;
+    for (int v = 0; v < n; v++) maxDegree = std::max(maxDegree, graph.count(v));
+    std::vector<int> byDegree;
+    {
+        std::vector<int> offsets, items;
+        bucketSort(pointCount, size_t(maxDegree) + 1, [&](size_t v, auto&& push) {
+            const int point = static_cast<int>(v);
+            push(graph.count(v), &point, 1);
+        }, offsets, byDegree, true);
+    }
+
+    GeoReordering r;
+    std::vector<int>& order = r.pointOrder;
+    order.reserve(pointCount);
+    std::vector<int> mark(pointCount, 0), queue;
+    std::vector<char> visited(pointCount, 0);
+    std::vector<int> neighbors;
+    int stamp = 0;
+    for (int seed : byDegree) {
+        if (visited[seed]) continue;
+
+        // 伪外围点（George-Liu）：反复取最后一层中度数最小的点，直到层数不再增加
+        int start = seed, last = seed;
+        int depth = breadthFirstDepth(graph, start, mark, ++stamp, queue, last);
+        for (int iteration = 0; iteration < 8 && last != start; iteration++) {
+            int candidateLast = last;
+            const int candidateDepth = breadthFirstDepth(graph, last, mark, ++stamp, queue, candidateLast);
+            if (candidateDepth <= depth) break;
+            start = last;
+            depth = candidateDepth;
+            last = candidateLast;
+        }
+
+        // Cuthill-McKee：按层遍历，每个点的未访问邻居按度数（相同时按编号）升序加入
+        size_t head = order.size();
+        order.push_back(start);
+        visited[start] = 1;
+        while (head < order.size()) {
+            const int u = order[head++];
+            neighbors.clear();
+            for (const int* v = graph.begin(u); v != graph.end(u); ++v) {
+                if (!visited[*v]) {
+                    visited[*v] = 1;
+                    neighbors.push_back(*v);
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end(), [&](int a, int b) {
+                const int da = graph.count(a), db = graph.count(b);
+                return da != db ? da < db : a < b;
+            });
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    r.pointRank.resize(pointCount);
+    for (int i = 0; i < n; i++) r.pointRank[order[i]] = i;
+    if (bandwidth) {
+        bandwidth->before = graphBandwidth(graph, nullptr);
+        bandwidth->after = graphBandwidth(graph, &r.pointRank);
+    }
+    return r;
+}
+
+void HoudiniGeoBuildBlockSparsity(const std::vector<int>& tetIndices, size_t pointCount, GeoBlockSparsity& out) {
+    GeoCSR graph;
+    HoudiniGeoPointAdjacency(tetIndices, {}, pointCount, graph);
+
+    // 点v的块列（即块行，结构对称）为邻居加上自身，起点为offsets[v] + v个块
+    auto blockStart = [&](size_t v) { return size_t(graph.offsets[v]) + v; };
+    auto blockCount = [&](size_t v) { return size_t(graph.count(v)) + 1; };
+    const size_t nonZeros = (graph.items.size() + pointCount) * 9;
+    if (nonZeros > size_t(INT32_MAX)) {
+        throw std::runtime_error("Too many nonzeros for the block sparsity pattern");
+    }
+
+    Eigen::SparseMatrix<double>& m = out.matrix;
+    m.resize(static_cast<Eigen::Index>(pointCount * 3), static_cast<Eigen::Index>(pointCount * 3));
+    m.resizeNonZeros(static_cast<Eigen::Index>(nonZeros));
+    int* outer = m.outerIndexPtr();
+    int* inner = m.innerIndexPtr();
+    std::fill(m.valuePtr(), m.valuePtr() + nonZeros, 0.0);
+    outer[pointCount * 3] = static_cast<int>(nonZeros);
+    HoudiniGeoParallelFor(0, pointCount, grainSize / 16, [&](size_t b, size_t e) {
+        for (size_t v = b; v < e; v++) {
+            const size_t blocks = blockCount(v);
+            for (int j = 0; j < 3; j++) {
+                const size_t column = 9 * blockStart(v) + 3 * blocks * j;
+                outer[v * 3 + j] = static_cast<int>(column);
+                int* rows = inner + column;
+                const int* neighbor = graph.begin(v);
+                bool diagonal = false;
+                for (size_t k = 0; k < blocks; k++) {
+                    // 邻居按编号升序，对角块插在比v大的第一个邻居之前
+                    int row;
+                    if (!diagonal && (neighbor == graph.end(v) || *neighbor > int(v))) {
+                        row = static_cast<int>(v);
+                        diagonal = true;
+                    }
+                    else {
+                        row = *neighbor++;
+                    }
+                    rows[k * 3] = row * 3;
+                    rows[k * 3 + 1] = row * 3 + 1;
+                    rows[k * 3 + 2] = row * 3 + 2;
+                }
+            }
+        }
+    });
+
+    const size_t tetCount = tetIndices.size() / 4;
+    out.blockBase.resize(tetCount * 16);
+    out.columnStride.resize(tetCount * 4);
+    HoudiniGeoParallelFor(0, tetCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t t = b; t < e; t++) {
+            const int* tet = tetIndices.data() + t * 4;
+            for (int c = 0; c < 4; c++) {
+                const int column = tet[c];
+                out.columnStride[t * 4 + c] = static_cast<int>(3 * blockCount(column));
+                for (int r = 0; r < 4; r++) {
+                    const int row = tet[r];
+                    // row在column的块列中的位置：比row小的邻居数，row在对角块之后时再加1
+                    size_t k = std::lower_bound(graph.begin(column), graph.end(column), row) - graph.begin(column);
+                    if (row > column) k++;
+                    out.blockBase[t * 16 + r * 4 + c] = static_cast<int>(9 * blockStart(column) + 3 * k);
+                }
+            }
+        }
+    });
+}
+
+void HoudiniGeoColorElements(const std::vector<int>& elements, int verticesPerElement, size_t pointCount,
+                             GeoColoring& out) {
+    if (verticesPerElement <= 0 || elements.size() % verticesPerElement != 0) {
+        throw std::runtime_error("Element indices size is not a multiple of the element size");
+    }
+    for (int v : elements) {
+        if (v < 0 || size_t(v) >= pointCount) {
+            throw std::runtime_error("Element index out of range: " + std::to_string(v));
+        }
+    }
+    const size_t count = elements.size() / verticesPerElement;
+    if (count > size_t(INT32_MAX)) {
+        throw std::runtime_error("Too many elements");
+    }
+
+    GeoCSR pointElements;
+    bucketSort(count, pointCount, [&](size_t i, auto&& push) {
+        const int element = static_cast<int>(i);
+        for (int k = 0; k < verticesPerElement; k++) {
+            push(elements[i * verticesPerElement + k], &element, 1);
+        }
+    }, pointElements.offsets, pointElements.items, true);
+
+    // 随机优先级（整数哈希），相同时按编号
+    auto priority = [](uint64_t i) {
+        i = (i ^ (i >> 30)) * 0xbf58476d1ce4e5b9ull;
+        i = (i ^ (i >> 27)) * 0x94d049bb133111ebull;
+        return i ^ (i >> 31);
+    };
+    auto before = [&](int a, int b) {
+        const uint64_t pa = priority(a), pb = priority(b);
+        return pa != pb ? pa > pb : a < b;
+    };
+    auto forNeighbors = [&](size_t e, auto&& fn) {
+        for (int k = 0; k < verticesPerElement; k++) {
+            const int p = elements[e * verticesPerElement + k];
+            for (const int* n = pointElements.begin(p); n != pointElements.end(p); ++n) {
+                if (size_t(*n) != e) fn(*n);
+            }
+        }
+    };
+
+    // waiting[e]：优先级更高、还没着色的邻居数（共用几个点就计几次）。为0的元素互不相邻，
+    // 着色时读到的邻居颜色都来自之前的轮次；着色后再给优先级更低的邻居减一，减到0的进入下一轮
+    std::unique_ptr<std::atomic<int>[]> waiting(new std::atomic<int>[count]);
+    HoudiniGeoParallelFor(0, count, grainSize / 16, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            int n = 0;
+            forNeighbors(i, [&](int other) { n += before(other, static_cast<int>(i)); });
+            waiting[i].store(n, std::memory_order_relaxed);
+        }
+    });
+    std::vector<int> frontier, next(count);
+    for (size_t i = 0; i < count; i++) {
+        if (waiting[i].load(std::memory_order_relaxed) == 0) frontier.push_back(static_cast<int>(i));
+    }
+
+    std::vector<int>& colors = out.colors;
+    colors.assign(count, -1);
+    while (!frontier.empty()) {
+        HoudiniGeoParallelFor(0, frontier.size(), grainSize / 16, [&](size_t b, size_t e) {
+            std::vector<uint8_t> used;
+            for (size_t i = b; i < e; i++) {
+                const int element = frontier[i];
+                forNeighbors(element, [&](int n) {
+                    if (colors[n] >= 0) {
+                        if (size_t(colors[n]) >= used.size()) used.resize(colors[n] + 1, 0);
+                        used[colors[n]] = 1;
+                    }
+                });
+                int color = 0;
+                while (size_t(color) < used.size() && used[color]) color++;
+                colors[element] = color;
+                std::fill(used.begin(), used.end(), 0);
+            }
+        });
+        std::atomic<size_t> tail(0);
+        HoudiniGeoParallelFor(0, frontier.size(), grainSize / 16, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) {
+                const int element = frontier[i];
+                forNeighbors(element, [&](int n) {
+                    if (before(element, n) && waiting[n].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        next[tail.fetch_add(1, std::memory_order_relaxed)] = n;
+                    }
+                });
+            }
+        });
+        frontier.assign(next.begin(), next.begin() + tail.load());
+    }
+
+    int colorCount = 0;
+    for (int c : colors) colorCount = std::max(colorCount, c + 1);
+    bucketSort(count, size_t(colorCount), [&](size_t i, auto&& push) {
+        const int element = static_cast<int>(i);
+        push(colors[i], &element, 1);
+    }, out.colorOffsets, out.order, true);
+}
+
+void HoudiniGeoLabelComponents(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                               size_t pointCount, GeoComponents& out, GeoReordering* contiguous) {
+    checkTetIndices(tetIndices, pointCount);
+    checkTriangleIndices(triangles, pointCount);
+    if (pointCount > size_t(INT32_MAX)) {
+        throw std::runtime_error("Too many points");
+    }
+
+    // parent[x] <= x始终成立，所以不会成环，根就是分量中最小的点
+    std::unique_ptr<std::atomic<int>[]> parent(new std::atomic<int>[pointCount]);
+    HoudiniGeoParallelFor(0, pointCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) parent[i].store(static_cast<int>(i), std::memory_order_relaxed);
+    });
+    auto find = [&](int x) {
+        for (;;) {
+            int p = parent[x].load(std::memory_order_relaxed);
+            if (p == x) return x;
+            const int grandparent = parent[p].load(std::memory_order_relaxed);
+            // 路径减半；失败说明别的线程已经把它挂得更高，同样正确
+            if (p != grandparent) parent[x].compare_exchange_weak(p, grandparent, std::memory_order_relaxed);
+            x = grandparent;
+        }
+    };
+    auto unite = [&](int a, int b) {
+        for (;;) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return;
+            if (a < b) std::swap(a, b);
+            int expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+        }
+    };
+    auto link = [&](const std::vector<int>& prims, int n) {
+        HoudiniGeoParallelFor(0, prims.size() / n, grainSize, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) {
+                const int* v = prims.data() + i * n;
+                for (int k = 1; k < n; k++) unite(v[0], v[k]);
+            }
+        });
+    };
+    link(tetIndices, 4);
+    link(triangles, 3);
+
+    std::vector<int>& points = out.pointComponent;
+    points.resize(pointCount);
+    HoudiniGeoParallelFor(0, pointCount, grainSize, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) points[i] = find(static_cast<int>(i));
+    });
+    // 根按编号升序编为0, 1, 2...；根不大于分量中的其它点，扫描到时已经编好
+    int componentCount = 0;
+    for (size_t i = 0; i < pointCount; i++) {
+        points[i] = size_t(points[i]) == i ? componentCount++ : points[points[i]];
+    }
+
+    auto primitiveComponents = [&](const std::vector<int>& prims, int n, std::vector<int>& ids) {
+        ids.resize(prims.size() / n);
+        HoudiniGeoParallelFor(0, ids.size(), grainSize, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) ids[i] = points[prims[i * n]];
+        });
+    };
+    primitiveComponents(tetIndices, 4, out.tetComponent);
+    primitiveComponents(triangles, 3, out.triangleComponent);
+
+    auto offsets = [&](const std::vector<int>& ids, std::vector<int>& result) {
+        result.assign(size_t(componentCount) + 1, 0);
+        for (int c : ids) result[c + 1]++;
+        for (int c = 0; c < componentCount; c++) result[c + 1] += result[c];
+    };
+    offsets(out.pointComponent, out.pointOffsets);
+    offsets(out.tetComponent, out.tetOffsets);
+    offsets(out.triangleComponent, out.triangleOffsets);
+
+    if (!contiguous) {
+        return;
+    }
+    int bits = 0;
+    while (bits < 31 && (1 << bits) < componentCount) bits++;
+    // 按分量编号稳定排序，分量内保持原顺序（例如之前的空间重排）
+    auto sortByComponent = [&](const std::vector<int>& ids, std::vector<int>& order, std::vector<int>& rank) {
+        std::vector<uint64_t> keys(ids.begin(), ids.end());
+        order.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); i++) order[i] = static_cast<int>(i);
+        radixSort(keys, &order, bits);
+        rank.resize(ids.size());
+        HoudiniGeoParallelFor(0, ids.size(), grainSize, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++) rank[order[i]] = static_cast<int>(i);
+        });
+    };
+    sortByComponent(out.pointComponent, contiguous->pointOrder, contiguous->pointRank);
+    sortByComponent(out.tetComponent, contiguous->tetOrder, contiguous->tetRank);
+    sortByComponent(out.triangleComponent, contiguous->triangleOrder, contiguous->triangleRank);
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include <Eigen/Sparse>
+
+
+// 由四面体导出的拓扑数据。输入都是HoudiniGeoIO中一维展开的数组：
+// tetIndices每4个一个四面体，positions每3个一个点。
+
+// 压缩行存储（CSR）：第i行为items[offsets[i]] .. items[offsets[i+1]-1]
+struct GeoCSR {
+    std::vector<int> offsets;  // 行数+1个
+    std::vector<int> items;
+
+    size_t rows() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    int count(size_t row) const { return offsets[row + 1] - offsets[row]; }
+    const int* begin(size_t row) const { return items.data() + offsets[row]; }
+    const int* end(size_t row) const { return items.data() + offsets[row + 1]; }
+};
+
+// 点和图元的重排：xxxOrder[新编号] = 原编号，xxxRank[原编号] = 新编号。
+// 某一类为空表示保持原顺序
+struct GeoReordering {
+    std::vector<int> pointOrder, pointRank;
+    std::vector<int> tetOrder, tetRank;
+    std::vector<int> triangleOrder, triangleRank;
+
+    // 反向的重排，用于把结果换回原顺序
+    GeoReordering inverse() const {
+        GeoReordering r;
+        r.pointOrder = pointRank;
+        r.pointRank = pointOrder;
+        r.tetOrder = tetRank;
+        r.tetRank = tetOrder;
+        r.triangleOrder = triangleRank;
+        r.triangleRank = triangleOrder;
+        return r;
+    }
+};
+
+// 由四面体连接得到的3x3分块稀疏结构和单元矩阵的散射表。
+// 单元矩阵为12x12，第a个顶点的第i个分量对应第3a+i行/列。组装时直接按下标累加，不需要每帧排序三元组：
+//   double* values = sparsity.matrix.valuePtr();
+//   for (int r = 0; r < 12; r++) for (int c = 0; c < 12; c++) values[sparsity.slot(t, r, c)] += Ke(r, c);
+// 不同四面体并行累加时需要按着色分组（见HoudiniGeoColorElements）或用原子加。
+struct GeoBlockSparsity {
+    Eigen::SparseMatrix<double> matrix;  // 3N x 3N，已压缩，非零结构为相连的点对（含对角块），值为0
+    std::vector<int> blockBase;          // 每个四面体16个：第a行、第b列顶点的3x3块的(0, 0)项在valuePtr()中的下标
+    std::vector<int> columnStride;       // 每个四面体4个：第b个顶点的块中相邻两列在valuePtr()中的间隔
+
+    int slot(size_t tet, int r, int c) const {
+        return blockBase[tet * 16 + (r / 3) * 4 + c / 3] + columnStride[tet * 4 + c / 3] * (c % 3) + r % 3;
+    }
+};
+
+// 元素着色：同一颜色的元素没有公共点，可以并行处理（Gauss-Seidel/XPBD）
+struct GeoColoring {
+    std::vector<int> colors;        // 每个元素的颜色
+    std::vector<int> order;         // 按颜色排列的元素编号，同一颜色内升序
+    std::vector<int> colorOffsets;  // 颜色数+1个：第c种颜色为order[colorOffsets[c]] .. order[colorOffsets[c+1]-1]
+
+    int colorCount() const { return colorOffsets.empty() ? 0 : static_cast<int>(colorOffsets.size()) - 1; }
+};
+
+// 连通分量：通过四面体和三角形的公共点连在一起的部分，按各分量最小的点编号排序编号。
+// 不属于任何图元的点各自算一个分量
+struct GeoComponents {
+    std::vector<int> pointComponent;     // 每个点的分量编号
+    std::vector<int> tetComponent;       // 每个四面体的
+    std::vector<int> triangleComponent;  // 每个三角形的
+    // 分量数+1个：按分量连续重排后，第c个分量的点为[pointOffsets[c], pointOffsets[c+1])，四面体和三角形同理
+    std::vector<int> pointOffsets, tetOffsets, triangleOffsets;
+
+    int count() const { return pointOffsets.empty() ? 0 : static_cast<int>(pointOffsets.size()) - 1; }
+};
+
+enum class GeoSpaceFillingCurve { Morton, Hilbert };
+
+// 点邻接矩阵的带宽：所有边max |i - j|
+struct GeoBandwidth {
+    size_t before = 0;
+    size_t after = 0;
+};
+
+struct GeoTetAdjacency {
+    // 每个四面体4个：第f个为隔着第f个面（与第f个顶点相对）的四面体，边界面为-1。
+    // 被两个以上四面体共用的（非流形）面也记为-1
+    std::vector<int> faceNeighbors;
+    GeoCSR pointTets;  // 点 -> 包含它的四面体，每行按四面体编号升序
+};
+
+// 边界面：只属于一个四面体的面（内部面成对抵消）。三角形按Houdini的绕序输出，
+// 与文件中Polygon_run的表面三角形一致（从外面看顺时针）。
+// isSurfacePoint不为空时按边界三角形的顶点精确标记表面点，大小为点数。
+// 面按最小顶点分桶后并行排序去重，开销与四面体数成线性。
+void HoudiniGeoExtractBoundary(const std::vector<int>& tetIndices, const std::vector<double>& positions,
+                               std::vector<int>& triangles, std::vector<bool>* isSurfacePoint = nullptr);
+
+// 四面体的面邻接和点->四面体关联。都用并行计数排序加前缀和构建，不为每个点分配vector
+void HoudiniGeoBuildTetAdjacency(const std::vector<int>& tetIndices, size_t pointCount, GeoTetAdjacency& out);
+
+// 不重复的边，来自四面体（每个6条）和三角形（每个3条），两者都可以为空。
+// edges每2个一条，小编号在前，按(小编号, 大编号)升序。边键编码成64位整数后并行基数排序去重。
+// restLengths不为空时写入每条边在positions中的长度
+void HoudiniGeoExtractEdges(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                            const std::vector<double>& positions, std::vector<int>& edges,
+                            std::vector<double>* restLengths = nullptr);
+
+// 空间填充曲线重排：点按位置、四面体和三角形按重心，在包围盒内量化成每轴21位后
+// 计算Morton/Hilbert编码并基数排序。编码相同时保持原顺序
+GeoReordering HoudiniGeoSpatialOrder(const std::vector<double>& positions, const std::vector<int>& tetIndices,
+                                     const std::vector<int>& triangles,
+                                     GeoSpaceFillingCurve curve = GeoSpaceFillingCurve::Hilbert);
+
+// 把每个元素tupleSize个分量的数组换成order给出的顺序（order[新编号] = 原编号），order为空时不变。
+// 例如positions用pointOrder、3；换回原顺序用inverse().pointOrder
+template<class T>
+void HoudiniGeoPermute(std::vector<T>& values, const std::vector<int>& order, int tupleSize = 1) {
+    if (order.empty()) {
+        return;
+    }
+    if (values.size() != order.size() * tupleSize) {
+        throw std::runtime_error("Permutation size does not match the array");
+    }
+    std::vector<T> permuted(values.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int k = 0; k < tupleSize; k++) {
+            permuted[i * tupleSize + k] = values[size_t(order[i]) * tupleSize + k];
+        }
+    }
+    values.swap(permuted);
+}
+
+// 图元的点索引数组：图元按primitiveOrder排列，点编号换成pointRank中的新编号（都可以为空）
+void HoudiniGeoRemapPrimitives(std::vector<int>& indices, int verticesPerPrimitive,
+                               const std::vector<int>& primitiveOrder, const std::vector<int>& pointRank);
+
+// 点邻接图：四面体和三角形的边，每行按点编号升序，不含自身
+void HoudiniGeoPointAdjacency(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                              size_t pointCount, GeoCSR& out);
+
+// Reverse Cuthill-McKee：每个连通分量从伪外围点出发在点邻接图上按层遍历（邻居按度数升序），
+// 最后整体反转，降低隐式求解中刚度矩阵的带宽。只重排点，图元保持原顺序；开销与边数近似线性。
+// bandwidth不为空时写入重排前后的带宽
+GeoReordering HoudiniGeoRCMOrder(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                                 size_t pointCount, GeoBandwidth* bandwidth = nullptr);
+
+// 并行构建tetIndices对应的分块稀疏结构（matrix的列压缩存储直接写入）和散射表
+void HoudiniGeoBuildBlockSparsity(const std::vector<int>& tetIndices, size_t pointCount, GeoBlockSparsity& out);
+
+// 并行Jones-Plassmann着色：元素为每verticesPerElement个点一组（四面体4、约束的边2、三角形3），
+// 每轮中随机优先级高于所有未着色邻居的元素取邻居没用过的最小颜色。每个元素记录还在等待的邻居数，总开销与邻接数成线性。
+// order可以直接用作重排（例如HoudiniGeoRemapPrimitives(tetIndices, 4, coloring.order, {})），
+// 使每种颜色的元素在内存中连续
+void HoudiniGeoColorElements(const std::vector<int>& elements, int verticesPerElement, size_t pointCount,
+                             GeoColoring& out);
+
+// 并行无锁并查集求连通分量：每个图元把各顶点并到第0个顶点上，根总是分量中最小的点编号
+// （大的根用CAS挂到小的根下，查找时路径减半），结果与线程数无关。
+// contiguous不为空时写入使每个分量的点、四面体和三角形各自连续的重排（分量内保持原顺序），
+// 应用后各分量可以按out中的区间分别交给不同的求解器，不需要拷贝
+void HoudiniGeoLabelComponents(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                               size_t pointCount, GeoComponents& out, GeoReordering* contiguous = nullptr);
@@ -0,0 +1,220 @@
+#include "HoudiniGeoValidate.h"
+#include "HoudiniGeoParallel.h"
+#include "HoudiniGeoRestState.h"
+#include "HoudiniGeoTopology.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+
+namespace {
+
+const size_t blockSize = 4096;
+const double pi = 3.14159265358979323846;
+
+// 与按编号顺序逐个更新相同：相等时保留编号小的
+void keepMin(double value, int index, double& minValue, int& minIndex) {
+    if (minIndex < 0 || value < minValue || (value == minValue && index < minIndex)) {
+        minValue = value;
+        minIndex = index;
+    }
+}
+
+size_t bin(double value, double width, size_t bins) {
+    return std::min(bins - 1, static_cast<size_t>(std::max(0.0, value / width)));
+}
+
+// 一块四面体的局部统计。minDihedral/minQuality/minVolume在count为0时没有意义
+struct BlockStats {
+    GeoMeshReport report;
+    size_t count = 0;  // 参与几何统计的四面体数
+    int minQualityTet = -1;
+    int maxDihedralTet = -1;
+};
+
+void sweepTet(const int* v, const double* P, int tet, BlockStats& stats) {
+    GeoMeshReport& r = stats.report;
+    const double* p[4] = {P + 3 * v[0], P + 3 * v[1], P + 3 * v[2], P + 3 * v[3]};
+    double c[3][3];
+    for (int e = 0; e < 3; e++) {
+        for (int k = 0; k < 3; k++) c[e][k] = p[e + 1][k] - p[0][k];
+    }
+    const double det = c[0][0] * (c[1][1] * c[2][2] - c[1][2] * c[2][1]) -
+                       c[0][1] * (c[1][0] * c[2][2] - c[1][2] * c[2][0]) +
+                       c[0][2] * (c[1][0] * c[2][1] - c[1][1] * c[2][0]);
+    // 六条边的长度平方
+    double lengthSqSum = 0.0, lengthSqMax = 0.0;
+    for (int a = 0; a < 4; a++) {
+        for (int b = a + 1; b < 4; b++) {
+            double l = 0.0;
+            for (int k = 0; k < 3; k++) l += (p[b][k] - p[a][k]) * (p[b][k] - p[a][k]);
+            lengthSqSum += l;
+            if (a == 0) lengthSqMax = std::max(lengthSqMax, l);  // 与Dm的三列一致
+        }
+    }
+    // Houdini的四面体det(Dm) < 0（见HoudiniGeoRestState.cpp）
+    const double volume = -det / 6.0;
+    const bool degenerate = !(std::fabs(det) > GeoDegenerateTetTolerance * lengthSqMax * std::sqrt(lengthSqMax));
+
+    stats.count++;
+    r.totalVolume += volume;
+    keepMin(volume, tet, r.minVolume, r.minVolumeTet);
+    if (stats.count == 1 || volume > r.maxVolume) r.maxVolume = volume;
+
+    // 退化的四面体按压扁的极限处理：二面角为0和180度，质量为0
+    double minAngle = 0.0, maxAngle = 180.0, quality = 0.0;
+    if (degenerate) {
+        r.degenerateTets++;
+    } else {
+        r.invertedTets += volume < 0.0;
+        // 各面的外法向（背离相对的顶点），二面角 = pi - 两个面外法向的夹角
+        double n[4][3];
+        for (int f = 0; f < 4; f++) {
+            const double* a = p[(f + 1) % 4];
+            const double* b = p[(f + 2) % 4];
+            const double* d = p[(f + 3) % 4];
+            const double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const double w[3] = {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+            double x[3] = {u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0]};
+            const double side = x[0] * (p[f][0] - a[0]) + x[1] * (p[f][1] - a[1]) + x[2] * (p[f][2] - a[2]);
+            const double scale = (side > 0.0 ? -1.0 : 1.0) / std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+            for (int k = 0; k < 3; k++) n[f][k] = x[k] * scale;
+        }
+        minAngle = 180.0;
+        maxAngle = 0.0;
+        for (int f = 0; f < 4; f++) {
+            for (int g = f + 1; g < 4; g++) {
+                const double cosine = std::max(-1.0, std::min(1.0, n[f][0] * n[g][0] + n[f][1] * n[g][1] + n[f][2] * n[g][2]));
+                const double angle = 180.0 - std::acos(cosine) * (180.0 / pi);
+                minAngle = std::min(minAngle, angle);
+                maxAngle = std::max(maxAngle, angle);
+            }
+        }
+        quality = std::min(1.0, 12.0 * std::cbrt(9.0 * volume * volume) / lengthSqSum);
+    }
+    r.minDihedralHistogram[bin(minAngle, 10.0, 18)]++;
+    r.maxDihedralHistogram[bin(maxAngle, 10.0, 18)]++;
+    r.qualityHistogram[bin(quality, 0.1, 10)]++;
+    keepMin(minAngle, tet, r.minDihedral, r.minDihedralTet);
+    keepMin(quality, tet, r.minQuality, stats.minQualityTet);
+    if (stats.maxDihedralTet < 0 || maxAngle > r.maxDihedral) {
+        r.maxDihedral = maxAngle;
+        stats.maxDihedralTet = tet;
+    }
+}
+
+void merge(const BlockStats& block, BlockStats& total) {
+    const GeoMeshReport& b = block.report;
+    GeoMeshReport& r = total.report;
+    r.badTets += b.badTets;
+    r.badTriangles += b.badTriangles;
+    r.degenerateTets += b.degenerateTets;
+    r.invertedTets += b.invertedTets;
+    for (size_t i = 0; i < r.minDihedralHistogram.size(); i++) {
+        r.minDihedralHistogram[i] += b.minDihedralHistogram[i];
+        r.maxDihedralHistogram[i] += b.maxDihedralHistogram[i];
+    }
+    for (size_t i = 0; i < r.qualityHistogram.size(); i++) r.qualityHistogram[i] += b.qualityHistogram[i];
+    if (block.count == 0) {
+        return;
+    }
+    r.totalVolume += b.totalVolume;
+    keepMin(b.minVolume, b.minVolumeTet, r.minVolume, r.minVolumeTet);
+    keepMin(b.minDihedral, b.minDihedralTet, r.minDihedral, r.minDihedralTet);
+    keepMin(b.minQuality, block.minQualityTet, r.minQuality, total.minQualityTet);
+    if (total.count == 0 || b.maxVolume > r.maxVolume) r.maxVolume = b.maxVolume;
+    if (total.maxDihedralTet < 0 || b.maxDihedral > r.maxDihedral) {
+        r.maxDihedral = b.maxDihedral;
+        total.maxDihedralTet = block.maxDihedralTet;
+    }
+    total.count += block.count;
+}
+
+}
+
+
+void GeoMeshReport::print(std::ostream& out) const {
+    out << "Mesh report: " << pointCount << " points, " << tetCount << " tets, " << triangleCount << " triangles\n";
+    out << "  bad tets: " << badTets << ", bad triangles: " << badTriangles
+        << ", degenerate: " << degenerateTets << ", inverted: " << invertedTets << "\n";
+    out << "  volume: min " << minVolume << " (tet " << minVolumeTet << "), max " << maxVolume
+        << ", total " << totalVolume << "\n";
+    out << "  dihedral: min " << minDihedral << " (tet " << minDihedralTet << "), max " << maxDihedral
+        << ", quality min " << minQuality << "\n";
+    out << "  min dihedral histogram (10 deg):";
+    for (size_t n : minDihedralHistogram) out << " " << n;
+    out << "\n  max dihedral histogram (10 deg):";
+    for (size_t n : maxDihedralHistogram) out << " " << n;
+    out << "\n  quality histogram (0.1):";
+    for (size_t n : qualityHistogram) out << " " << n;
+    out << "\n  unreferenced points: " << unreferencedPoints;
+    if (surfaceChecked) {
+        out << ", surface points missing: " << missingSurfacePoints << ", extra: " << extraSurfacePoints;
+    }
+    out << "\n";
+}
+
+GeoMeshReport HoudiniGeoValidateMesh(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                                     const std::vector<double>& positions, const std::vector<bool>& isSurfacePoint) {
+    const size_t pointCount = positions.size() / 3;
+    const size_t tetCount = tetIndices.size() / 4;
+    const size_t triangleCount = triangles.size() / 3;
+    const int* tets = tetIndices.data();
+    const double* P = positions.data();
+    auto inRange = [&](int v) { return v >= 0 && size_t(v) < pointCount; };
+
+    std::unique_ptr<std::atomic<uint8_t>[]> referenced(new std::atomic<uint8_t>[pointCount]);
+    for (size_t p = 0; p < pointCount; p++) referenced[p].store(0, std::memory_order_relaxed);
+
+    // 块的划分固定，和线程数无关；每块只写自己的局部结果
+    const size_t blockCount = (tetCount + blockSize - 1) / blockSize;
+    std::vector<BlockStats> blocks(blockCount);
+    HoudiniGeoParallelFor(0, blockCount, 1, [&](size_t bb, size_t be) {
+        for (size_t block = bb; block < be; block++) {
+            BlockStats& stats = blocks[block];
+            const size_t end = std::min(tetCount, (block + 1) * blockSize);
+            for (size_t t = block * blockSize; t < end; t++) {
+                const int* v = tets + 4 * t;
+                bool valid = inRange(v[0]) && inRange(v[1]) && inRange(v[2]) && inRange(v[3]);
+                for (int a = 0; valid && a < 4; a++) {
+                    for (int b = a + 1; b < 4; b++) valid = valid && v[a] != v[b];
+                }
+                if (!valid) {
+                    stats.report.badTets++;
+                    continue;
+                }
+                for (int k = 0; k < 4; k++) referenced[v[k]].store(1, std::memory_order_relaxed);
+                sweepTet(v, P, static_cast<int>(t), stats);
+            }
+        }
+    });
+
+    BlockStats total;
+    for (const BlockStats& block : blocks) merge(block, total);
+    GeoMeshReport report = total.report;
+    report.pointCount = pointCount;
+    report.tetCount = tetCount;
+    report.triangleCount = triangleCount;
+    // 数组末尾不足一个图元的部分
+    report.badTets += tetIndices.size() % 4 != 0;
+    report.badTriangles += triangles.size() % 3 != 0;
+    for (size_t i = 0; i < triangleCount * 3; i += 3) {
+        report.badTriangles += !(inRange(triangles[i]) && inRange(triangles[i + 1]) && inRange(triangles[i + 2]));
+    }
+    for (size_t p = 0; p < pointCount; p++) {
+        report.unreferencedPoints += referenced[p].load(std::memory_order_relaxed) == 0;
+    }
+
+    if (isSurfacePoint.size() == pointCount && pointCount > 0 && report.badTets == 0) {
+        std::vector<int> boundary;
+        std::vector<bool> onBoundary;
+        HoudiniGeoExtractBoundary(tetIndices, positions, boundary, &onBoundary);
+        report.surfaceChecked = true;
+        for (size_t p = 0; p < pointCount; p++) {
+            report.missingSurfacePoints += onBoundary[p] && !isSurfacePoint[p];
+            report.extraSurfacePoints += !onBoundary[p] && isSurfacePoint[p];
+        }
+    }
+    return report;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+
+// 四面体网格的检查结果。体积按Houdini的朝向取正，反向的四面体体积为负。
+struct GeoMeshReport {
+    size_t pointCount = 0;
+    size_t tetCount = 0;
+    size_t triangleCount = 0;
+
+    size_t badTets = 0;        // 索引越界或有重复顶点的四面体，不参与下面的几何统计
+    size_t badTriangles = 0;   // 索引越界的三角形
+    size_t degenerateTets = 0; // 与GeoTetState::Degenerate相同的标准
+    size_t invertedTets = 0;
+
+    double minVolume = 0.0;
+    double maxVolume = 0.0;
+    double totalVolume = 0.0;
+    int minVolumeTet = -1;
+
+    // 每个四面体的最小/最大二面角，每10度一格；退化的四面体最小二面角记为0、最大记为180（最后一格），质量记为0
+    std::array<size_t, 18> minDihedralHistogram{};
+    std::array<size_t, 18> maxDihedralHistogram{};
+    double minDihedral = 0.0;  // 度
+    double maxDihedral = 0.0;
+    int minDihedralTet = -1;
+
+    // 形状质量（mean ratio）：12 * (3V)^(2/3) / 六条边长的平方和，正四面体为1，退化为0；每0.1一格
+    std::array<size_t, 10> qualityHistogram{};
+    double minQuality = 0.0;
+
+    size_t unreferencedPoints = 0;  // 不属于任何四面体的点
+
+    // surface_points点组与由四面体提取的实际边界（HoudiniGeoExtractBoundary）的对比，
+    // 没有点组或有越界四面体时不检查
+    bool surfaceChecked = false;
+    size_t missingSurfacePoints = 0;  // 在边界上但没有标记
+    size_t extraSurfacePoints = 0;    // 标记了但不在边界上
+
+    bool ok() const {
+        return badTets == 0 && badTriangles == 0 && degenerateTets == 0 && invertedTets == 0 &&
+               unreferencedPoints == 0 && missingSurfacePoints == 0 && extraSurfacePoints == 0;
+    }
+    void print(std::ostream& out) const;
+};
+
+// 并行检查网格：四面体只遍历一遍，同时完成索引、有向体积、二面角和形状质量的统计以及点的引用标记，
+// 各块的局部结果按块顺序合并，结果与线程数无关。isSurfacePoint为空时不做表面点对比
+GeoMeshReport HoudiniGeoValidateMesh(const std::vector<int>& tetIndices, const std::vector<int>& triangles,
+                                     const std::vector<double>& positions, const std::vector<bool>& isSurfacePoint);
@@ -3,10 +3,39 @@ set(CMAKE_CXX_STANDARD_REQUIRED ON)
 set(HoudiniGeoIO_SRCS
     ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoIO.cpp
     ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoIO.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoBinary.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoBinary.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoBinding.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoBinding.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoGzip.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoGzip.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoLayout.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoLayout.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoParallel.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoQuantize.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoQuantize.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoRestState.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoRestState.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoScan.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoScan.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoSequence.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoSequence.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoStream.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoStream.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoTopology.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoTopology.h
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoValidate.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../HoudiniGeoValidate.h
 )
 set(HoudiniGeoIO_INCLUDE_DIR
     ${CMAKE_CURRENT_LIST_DIR}/../
 )
+# 可选的zlib（.geo.gz/.bgeo.gz）
+find_package(ZLIB QUIET)
+if(ZLIB_FOUND)
+    set(HoudiniGeoIO_DEFINITIONS HOUDINIGEOIO_WITH_ZLIB)
+    set(HoudiniGeoIO_LIBRARIES ZLIB::ZLIB)
+endif()
 
 # Usage:
 # find_package(HoudiniGeoIO REQUIRED PATHS /path/to/HoudiniGeoIO)
@@ -18,3 +47,5 @@ set(HoudiniGeoIO_INCLUDE_DIR
 # 	${YOUR_SRCS}
 # )
 # target_include_directories(YouApplication PRIVATE ${HoudiniGeoIO_INCLUDE_DIR})
+# target_compile_definitions(YouApplication PRIVATE ${HoudiniGeoIO_DEFINITIONS})
+# target_link_libraries(YouApplication ${HoudiniGeoIO_LIBRARIES})
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "HoudiniGeoIO.h"
+
+
+// 统计全局operator new的调用次数，检查复用缓冲区模式下位置逐帧变化、拓扑不变的序列在第一帧之后读取不分配内存
+namespace {
+std::atomic<size_t> allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+
+// 把源文件的位置按frame扰动后写出。每帧所有点都移动，另外每4个分量中有一个在不同帧里
+// 取整（文本变短）或取反（多一个负号），所以同一个数字的文本长度逐帧变化。
+// 文件总大小的变化在缓冲区预留的余量（1/16）之内，与真实序列的情况相同
+std::vector<std::string> writeFrames(const std::string& source, const std::filesystem::path& dir, int frames) {
+    HoudiniGeoIO geo;
+    geo.read(source);
+    const std::vector<double> rest = geo.getPositions();
+    std::filesystem::create_directories(dir);
+    std::vector<std::string> paths;
+    for (int f = 0; f < frames; f++) {
+        std::vector<double> pos(rest);
+        for (size_t i = 0; i < pos.size(); i++) {
+            pos[i] += 1e-3 * (f + 1) * std::sin(double(i));
+            if (i % 4 == 0 && f % 3 == 1) pos[i] = std::round(pos[i] * 2.0) / 2.0;
+            if (i % 4 == 0 && f % 3 == 2) pos[i] = -pos[i];
+        }
+        geo.setPositions(pos);
+        paths.push_back((dir / ("frame." + std::to_string(f) + ".geo")).string());
+        geo.write(paths.back());
+    }
+    return paths;
+}
+
+// 按顺序轮流读取各帧rounds遍，第一次读取之后每次都不能分配
+bool checkReads(const char* name, const std::vector<std::string>& paths, int rounds, bool tetWithSurface) {
+    HoudiniGeoIO geo;
+    geo.setReuseBuffers(true);
+    bool ok = true;
+    for (int r = 0; r < rounds; r++) {
+        for (size_t f = 0; f < paths.size(); f++) {
+            const size_t before = allocations.load();
+            if (tetWithSurface) geo.readTetWithSurface(paths[f]);
+            else geo.read(paths[f]);
+            const size_t count = allocations.load() - before;
+            std::cout << name << " round " << r << " frame " << f << ": " << count << " allocations" << std::endl;
+            if ((r > 0 || f > 0) && count != 0) {
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+
+// 用法：HoudiniGeoIO_alloc_test <file.geo> [帧数]
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <file.geo> [frames]" << std::endl;
+        return 2;
+    }
+    const std::string source = argv[1];
+    const int frames = argc > 2 ? std::max(2, std::atoi(argv[2])) : 4;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "HoudiniGeoAllocTest";
+
+    bool ok = true;
+    try {
+        const std::vector<std::string> paths = writeFrames(source, dir, frames);
+        ok = checkReads("read", paths, 2, false) && ok;
+        ok = checkReads("readTetWithSurface", paths, 2, true) && ok;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::filesystem::remove_all(dir);
+    if (!ok) {
+        std::cerr << "FAILED: reads after the first frame allocated memory" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}